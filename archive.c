@@ -0,0 +1,104 @@
+#include "archive.h"
+#include <string.h>
+
+// Bytes an entry's pixels take over all its mip levels; 0 if its shape or format is invalid
+static size_t GetEntryDataSize(const ArchiveEntry *entry) {
+    if (entry->width <= 0 || entry->height <= 0 || entry->width > ARCHIVE_MAX_SIDE || entry->height > ARCHIVE_MAX_SIDE ||
+        entry->mipmaps < 1 || entry->mipmaps > ARCHIVE_MAX_MIPMAPS) return 0;
+
+    size_t total = 0;
+    int width = entry->width;
+    int height = entry->height;
+    for (int level = 0; level < entry->mipmaps; level++) {
+        // Uncompressed rows are whole bytes, so one row at a time keeps raylib's int maths from overflowing
+        size_t size = (entry->format < PIXELFORMAT_COMPRESSED_DXT1_RGB)
+            ? (size_t)GetPixelDataSize(width, 1, entry->format) * height
+            : (size_t)GetPixelDataSize(width, height, entry->format);
+        if (size == 0) return 0;
+        total += size;
+        width = (width > 1) ? width / 2 : 1;
+        height = (height > 1) ? height / 2 : 1;
+    }
+    return total;
+}
+
+bool LoadAssetArchive(const char *fileName, AssetArchive *archive) {
+    *archive = (AssetArchive){ 0 };
+    if (!MapFile(fileName, &archive->file)) return false;
+
+    // Reject anything whose table or data would run past the end of the file, or
+    // whose data is shorter than the pixels its size and format describe
+    const ArchiveHeader *header = (const ArchiveHeader *)archive->file.data;
+    bool valid = archive->file.size >= sizeof(ArchiveHeader) &&
+                 header->magic == ARCHIVE_MAGIC &&
+                 header->version == ARCHIVE_VERSION &&
+                 sizeof(ArchiveHeader) + (size_t)header->entryCount * sizeof(ArchiveEntry) <= archive->file.size;
+
+    const ArchiveEntry *entries = (const ArchiveEntry *)(archive->file.data + sizeof(ArchiveHeader));
+    for (unsigned int i = 0; valid && i < header->entryCount; i++) {
+        size_t pixels = GetEntryDataSize(&entries[i]);
+        valid = (size_t)entries[i].offset + entries[i].size <= archive->file.size &&
+                pixels > 0 && entries[i].size >= pixels;
+    }
+    if (!valid) {
+        TraceLog(LOG_WARNING, "ARCHIVE: [%s] is not a valid asset archive", fileName);
+        UnmapFile(&archive->file);
+        return false;
+    }
+
+    archive->entries = entries;
+    archive->entryCount = (int)header->entryCount;
+    TraceLog(LOG_INFO, "ARCHIVE: [%s] mapped, %d entries", fileName, archive->entryCount);
+    return true;
+}
+
+void UnloadAssetArchive(AssetArchive *archive) {
+    UnmapFile(&archive->file);
+    *archive = (AssetArchive){ 0 };
+}
+
+// The packer sorts the table, so lookups are a binary search
+const ArchiveEntry *FindArchiveEntry(const AssetArchive *archive, const char *name) {
+    int low = 0;
+    int high = archive->entryCount - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        int order = strncmp(name, archive->entries[mid].name, ARCHIVE_NAME_LENGTH);
+        if (order == 0) return &archive->entries[mid];
+        if (order < 0) {
+            high = mid - 1;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return NULL;
+}
+
+Texture2D LoadArchiveTexture(const AssetArchive *archive, const char *fileName) {
+    const ArchiveEntry *entry = FindArchiveEntry(archive, fileName);
+    if (entry == NULL) return LoadTexture(fileName);
+
+    // The image borrows the mapped pixels; the upload reads them in place and nothing is freed here
+    Image image = {
+        .data = (void *)(archive->file.data + entry->offset),
+        .width = entry->width,
+        .height = entry->height,
+        .mipmaps = entry->mipmaps,
+        .format = entry->format
+    };
+    return LoadTextureFromImage(image);
+}
+
+Image LoadArchiveImage(const AssetArchive *archive, const char *fileName) {
+    const ArchiveEntry *entry = FindArchiveEntry(archive, fileName);
+    if (entry == NULL) return LoadImage(fileName);
+
+    Image image = {
+        .data = (void *)(archive->file.data + entry->offset),
+        .width = entry->width,
+        .height = entry->height,
+        .mipmaps = entry->mipmaps,
+        .format = entry->format
+    };
+    return ImageCopy(image);
+}
@@ -0,0 +1,50 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include "raylib.h"
+#include "mapfile.h"
+
+#define ARCHIVE_MAGIC 0x4B415053         // "SPAK"
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_NAME_LENGTH 48
+#define ARCHIVE_ALIGNMENT 64             // Pixel data offsets are multiples of this
+#define ARCHIVE_MAX_SIDE 8192            // Largest width or height an entry may have
+#define ARCHIVE_MAX_MIPMAPS 14           // Levels of an ARCHIVE_MAX_SIDE texture down to 1 pixel
+
+// File layout: header, table of contents sorted by name, then the decoded
+// pixels of every entry, ready to hand to the GPU as they are.
+typedef struct ArchiveHeader {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int entryCount;
+    unsigned int reserved;
+} ArchiveHeader;
+
+typedef struct ArchiveEntry {
+    char name[ARCHIVE_NAME_LENGTH];      // Path the asset was packed from, e.g. "images/submarine.png"
+    unsigned int offset;                 // From the start of the file
+    unsigned int size;
+    int width;
+    int height;
+    int format;                          // PixelFormat
+    int mipmaps;
+} ArchiveEntry;
+
+// Packed textures, mapped rather than read. Once the textures are uploaded
+// the archive can be unloaded.
+typedef struct AssetArchive {
+    MappedFile file;
+    const ArchiveEntry *entries;
+    int entryCount;
+} AssetArchive;
+
+// Returns false if the file is missing or not an archive of this version
+bool LoadAssetArchive(const char *fileName, AssetArchive *archive);
+void UnloadAssetArchive(AssetArchive *archive);
+const ArchiveEntry *FindArchiveEntry(const AssetArchive *archive, const char *name);
+// Uploads straight from the mapping; assets not in the archive load from their loose file
+Texture2D LoadArchiveTexture(const AssetArchive *archive, const char *fileName);
+// A CPU copy that outlives the archive, for reading pixels back
+Image LoadArchiveImage(const AssetArchive *archive, const char *fileName);
+
+#endif
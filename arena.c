@@ -0,0 +1,60 @@
+#include "arena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+
+Arena LoadArena(size_t size) {
+    Arena arena = { 0 };
+    arena.base = malloc(size);
+    if (arena.base != NULL) arena.size = size;
+    return arena;
+}
+
+void UnloadArena(Arena arena) {
+    free(arena.base);
+}
+
+static void Claim(Arena *arena, size_t end) {
+    arena->used = end;
+    if (end > arena->highWater) arena->highWater = end;
+}
+
+void *ArenaAlloc(Arena *arena, size_t size) {
+    size_t start = (arena->used + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    if (start > arena->size || size > arena->size - start) {
+        arena->failures++;
+        return NULL;
+    }
+    Claim(arena, start + size);
+    return arena->base + start;
+}
+
+const char *ArenaFormat(Arena *arena, const char *format, ...) {
+    char *text = (char *)arena->base + arena->used;
+    size_t available = arena->size - arena->used;
+
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(text, available, format, args);
+    va_end(args);
+
+    // Strings need no alignment; the next ArenaAlloc realigns
+    if (length < 0 || (size_t)length >= available) {
+        arena->failures++;
+        return "";
+    }
+    Claim(arena, arena->used + length + 1);
+    return text;
+}
+
+void ResetArena(Arena *arena) {
+    arena->used = 0;
+}
+
+size_t GetArenaMark(const Arena *arena) {
+    return arena->used;
+}
+
+void RewindArena(Arena *arena, size_t mark) {
+    if (mark < arena->used) arena->used = mark;
+}
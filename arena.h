@@ -0,0 +1,33 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#define ARENA_ALIGNMENT 16
+
+// Linear allocator over one block reserved at load. Allocation bumps an
+// offset and everything is freed at once by a reset, so data that lives for a
+// frame or a level costs no malloc and never uses more than the block.
+typedef struct Arena {
+    unsigned char *base;
+    size_t size;
+    size_t used;
+    size_t highWater;            // Most ever in use at once, across resets
+    int failures;                // Requests refused because the block was full
+} Arena;
+
+Arena LoadArena(size_t size);
+void UnloadArena(Arena arena);
+// ARENA_ALIGNMENT-aligned and uninitialised; NULL when the block is full
+void *ArenaAlloc(Arena *arena, size_t size);
+// Formats into the arena like TextFormat, without a rotating buffer to outlive;
+// "" when the block is full
+const char *ArenaFormat(Arena *arena, const char *format, ...);
+// Frees everything allocated since load or the last reset
+void ResetArena(Arena *arena);
+// Where the next allocation starts; hand it back to RewindArena to free what came after
+size_t GetArenaMark(const Arena *arena);
+void RewindArena(Arena *arena, size_t mark);
+
+#endif
@@ -0,0 +1,98 @@
+#include "bitmask.h"
+#include <stdlib.h>
+#include <math.h>
+
+#define WORD_BITS 64
+
+BitMask BuildBitMask(Image image, int width, int height, unsigned char threshold, bool flipX) {
+    BitMask mask = { 0 };
+    if (image.data == NULL || width <= 0 || height <= 0) return mask;
+
+    // Whatever the image's format, read it back as 8-bit RGBA once
+    Color *pixels = LoadImageColors(image);
+    if (pixels == NULL) return mask;
+
+    mask.wordsPerRow = (width + WORD_BITS - 1) / WORD_BITS;
+    mask.rows = calloc((size_t)height * mask.wordsPerRow, sizeof(unsigned long long));
+    if (mask.rows == NULL) {
+        UnloadImageColors(pixels);
+        return mask;
+    }
+    mask.width = width;
+    mask.height = height;
+
+    for (int y = 0; y < height; y++) {
+        int sourceY = y * image.height / height;
+        unsigned long long *row = &mask.rows[y * mask.wordsPerRow];
+        for (int x = 0; x < width; x++) {
+            int sourceX = x * image.width / width;
+            if (flipX) sourceX = image.width - 1 - sourceX;
+            if (pixels[sourceY * image.width + sourceX].a > threshold) {
+                row[x / WORD_BITS] |= 1ull << (x % WORD_BITS);
+            }
+        }
+    }
+    UnloadImageColors(pixels);
+    return mask;
+}
+
+void UnloadBitMask(BitMask mask) {
+    free(mask.rows);
+}
+
+// 64 columns of a row starting at column; columns past the width read as clear
+static unsigned long long ReadBits(const unsigned long long *row, int wordsPerRow, int column) {
+    int word = column / WORD_BITS;
+    int shift = column % WORD_BITS;
+    unsigned long long bits = row[word] >> shift;
+    if (shift != 0 && word + 1 < wordsPerRow) bits |= row[word + 1] << (WORD_BITS - shift);
+    return bits;
+}
+
+static unsigned long long LowBits(int count) {
+    return (count >= WORD_BITS) ? ~0ull : (1ull << count) - 1;
+}
+
+// Intersection of the masks' areas and clip, in whole pixels
+static bool ClipSpan(int *x0, int *y0, int *x1, int *y1, int x, int y, int width, int height) {
+    if (x > *x0) *x0 = x;
+    if (y > *y0) *y0 = y;
+    if (x + width < *x1) *x1 = x + width;
+    if (y + height < *y1) *y1 = y + height;
+    return *x0 < *x1 && *y0 < *y1;
+}
+
+bool MasksOverlap(const BitMask *a, int ax, int ay, const BitMask *b, int bx, int by, Rectangle clip) {
+    int x0 = (int)floorf(clip.x);
+    int y0 = (int)floorf(clip.y);
+    int x1 = (int)ceilf(clip.x + clip.width);
+    int y1 = (int)ceilf(clip.y + clip.height);
+    if (!ClipSpan(&x0, &y0, &x1, &y1, ax, ay, a->width, a->height)) return false;
+    if (!ClipSpan(&x0, &y0, &x1, &y1, bx, by, b->width, b->height)) return false;
+
+    for (int y = y0; y < y1; y++) {
+        const unsigned long long *rowA = &a->rows[(y - ay) * a->wordsPerRow];
+        const unsigned long long *rowB = &b->rows[(y - by) * b->wordsPerRow];
+        for (int x = x0; x < x1; x += WORD_BITS) {
+            unsigned long long bits = ReadBits(rowA, a->wordsPerRow, x - ax) & ReadBits(rowB, b->wordsPerRow, x - bx);
+            if (bits & LowBits(x1 - x)) return true;
+        }
+    }
+    return false;
+}
+
+bool MaskOverlapsRect(const BitMask *mask, int x, int y, Rectangle rect) {
+    int x0 = (int)floorf(rect.x);
+    int y0 = (int)floorf(rect.y);
+    int x1 = (int)ceilf(rect.x + rect.width);
+    int y1 = (int)ceilf(rect.y + rect.height);
+    if (!ClipSpan(&x0, &y0, &x1, &y1, x, y, mask->width, mask->height)) return false;
+
+    for (int row = y0; row < y1; row++) {
+        const unsigned long long *bits = &mask->rows[(row - y) * mask->wordsPerRow];
+        for (int column = x0; column < x1; column += WORD_BITS) {
+            if (ReadBits(bits, mask->wordsPerRow, column - x) & LowBits(x1 - column)) return true;
+        }
+    }
+    return false;
+}
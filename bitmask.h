@@ -0,0 +1,25 @@
+#ifndef BITMASK_H
+#define BITMASK_H
+
+#include "raylib.h"
+
+// Which pixels of a sprite are solid, one bit each, 64 to a word along a row.
+// Built once from the image's alpha at the size the sprite is drawn, so one
+// bit covers one playfield pixel and two masks line up by shifting.
+typedef struct BitMask {
+    int width;
+    int height;
+    int wordsPerRow;
+    unsigned long long *rows;    // height * wordsPerRow; bit b of word w is column w * 64 + b
+} BitMask;
+
+// Samples image (nearest) into a width x height mask; pixels with alpha above threshold are set
+BitMask BuildBitMask(Image image, int width, int height, unsigned char threshold, bool flipX);
+void UnloadBitMask(BitMask mask);
+// Whether a set pixel of a, with its top-left at a's position, lands on a set
+// pixel of b inside clip. Positions are whole playfield pixels.
+bool MasksOverlap(const BitMask *a, int ax, int ay, const BitMask *b, int bx, int by, Rectangle clip);
+// Whether any set pixel of mask inside rect
+bool MaskOverlapsRect(const BitMask *mask, int x, int y, Rectangle rect);
+
+#endif
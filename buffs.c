@@ -0,0 +1,53 @@
+#include "buffs.h"
+#include <stddef.h>
+
+#define BASE_BOOST_ENERGY_COST 1.0f
+#define BASE_KILL_ENERGY 25.0f
+
+static const BuffDef buffDefs[BUFF_COUNT] = {
+    [BUFF_LIFESTEAL] = { 5, 0, 1, {
+        { STAT_KILL_HEAL, MODIFIER_ADD, 10.0f } } },
+    [BUFF_UNLIMITED_SPECIAL] = { 1, 0, 1, {
+        { STAT_SPECIAL_COOLDOWN, MODIFIER_SCALE, 0.0f } } },
+    [BUFF_UNLIMITED_ENERGY] = { 1, BUFF_EFFECT_REFILL_ENERGY, 1, {
+        { STAT_BOOST_ENERGY_COST, MODIFIER_SCALE, 0.0f } } },
+    [BUFF_FULL_HEALTH] = { 255, BUFF_EFFECT_RESTORE_HEALTH, 0 },
+};
+
+// Where each stat lives in RunStats
+static const size_t statOffsets[STAT_COUNT] = {
+    [STAT_BOOST_ENERGY_COST] = offsetof(RunStats, boostEnergyCost),
+    [STAT_SPECIAL_COOLDOWN] = offsetof(RunStats, specialCooldown),
+    [STAT_KILL_ENERGY] = offsetof(RunStats, killEnergy),
+    [STAT_KILL_HEAL] = offsetof(RunStats, killHeal),
+};
+
+const BuffDef *GetBuffDef(BuffId buff) {
+    return &buffDefs[buff];
+}
+
+RunStats ResolveRunStats(const unsigned char *stacks, const GameConfig *config) {
+    RunStats stats = {
+        .boostEnergyCost = BASE_BOOST_ENERGY_COST,
+        .specialCooldown = config->heavyBulletCooldown,
+        .killEnergy = BASE_KILL_ENERGY,
+        .killHeal = 0.0f,
+    };
+
+    // Additions first, so a scale applies to the whole sum whatever order buffs were picked in
+    for (int op = MODIFIER_ADD; op <= MODIFIER_SCALE; op++) {
+        for (int b = 0; b < BUFF_COUNT; b++) {
+            const BuffDef *def = &buffDefs[b];
+            for (int m = 0; m < def->modifierCount; m++) {
+                const StatModifier *modifier = &def->modifiers[m];
+                if (modifier->op != (ModifierOp)op) continue;
+
+                float *value = (float *)((char *)&stats + statOffsets[modifier->stat]);
+                for (int s = 0; s < stacks[b]; s++) {
+                    *value = (op == MODIFIER_ADD) ? *value + modifier->value : *value * modifier->value;
+                }
+            }
+        }
+    }
+    return stats;
+}
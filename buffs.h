@@ -0,0 +1,64 @@
+#ifndef BUFFS_H
+#define BUFFS_H
+
+#include "config.h"
+
+#define BUFF_MAX_MODIFIERS 4
+
+typedef enum BuffId {
+    BUFF_LIFESTEAL,
+    BUFF_UNLIMITED_SPECIAL,
+    BUFF_UNLIMITED_ENERGY,
+    BUFF_FULL_HEALTH,
+    BUFF_COUNT
+} BuffId;
+
+// Every value a buff can change; each names a field of RunStats
+typedef enum StatId {
+    STAT_BOOST_ENERGY_COST,
+    STAT_SPECIAL_COOLDOWN,
+    STAT_KILL_ENERGY,
+    STAT_KILL_HEAL,
+    STAT_COUNT
+} StatId;
+
+// The numbers the simulation reads every tick, with every held buff already
+// folded in, so the hot paths never check which buffs are held
+typedef struct RunStats {
+    float boostEnergyCost;       // Energy one boosted tick drains
+    float specialCooldown;       // Seconds between special attacks
+    float killEnergy;            // Energy each kill gives every submarine still in the fight
+    float killHeal;              // Health each kill gives every submarine still in the fight
+} RunStats;
+
+typedef enum ModifierOp {
+    MODIFIER_ADD,
+    MODIFIER_SCALE
+} ModifierOp;
+
+typedef struct StatModifier {
+    StatId stat;
+    ModifierOp op;
+    float value;
+} StatModifier;
+
+// What a buff does the moment it is picked, besides its modifiers
+typedef enum BuffEffect {
+    BUFF_EFFECT_REFILL_ENERGY = 1 << 0,
+    BUFF_EFFECT_RESTORE_HEALTH = 1 << 1  // Also brings a downed submarine back
+} BuffEffect;
+
+// A buff is data: modifiers applied once per stack held, plus instant effects
+typedef struct BuffDef {
+    int maxStacks;
+    unsigned int effects;        // BuffEffect flags
+    int modifierCount;
+    StatModifier modifiers[BUFF_MAX_MODIFIERS];
+} BuffDef;
+
+const BuffDef *GetBuffDef(BuffId buff);
+// Folds stacks[BUFF_COUNT] into the base values: every stack's additions,
+// then every stack's scales. Call only when the stacks or the tuning change.
+RunStats ResolveRunStats(const unsigned char *stacks, const GameConfig *config);
+
+#endif
@@ -0,0 +1,195 @@
+#include "bullets.h"
+#include "collision.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Per-bullet bytes across all arrays, used to carve them from one allocation
+#define BULLET_FLOATS 6
+#define BULLET_BYTES (BULLET_FLOATS * sizeof(float) + sizeof(Color) + sizeof(unsigned char))
+
+static void MoveBullet(BulletField *field, int to, int from) {
+    field->x[to] = field->x[from];
+    field->y[to] = field->y[from];
+    field->vx[to] = field->vx[from];
+    field->vy[to] = field->vy[from];
+    field->width[to] = field->width[from];
+    field->height[to] = field->height[from];
+    field->color[to] = field->color[from];
+    field->damage[to] = field->damage[from];
+}
+
+BulletField LoadBulletField(int capacity) {
+    BulletField field = { 0 };
+
+    // Floats first so every float array stays aligned for vector loads
+    char *block = malloc((size_t)capacity * BULLET_BYTES);
+    if (block == NULL) return field;
+
+    float *floats = (float *)block;
+    field.x = floats;
+    field.y = floats + capacity;
+    field.vx = floats + capacity * 2;
+    field.vy = floats + capacity * 3;
+    field.width = floats + capacity * 4;
+    field.height = floats + capacity * 5;
+    field.color = (Color *)(floats + capacity * BULLET_FLOATS);
+    field.damage = (unsigned char *)(field.color + capacity);
+    field.capacity = capacity;
+    return field;
+}
+
+void UnloadBulletField(BulletField field) {
+    free(field.x);
+}
+
+bool ResizeBulletField(BulletField *field, int capacity) {
+    BulletField resized = LoadBulletField(capacity);
+    if (resized.x == NULL) return false;
+
+    // Shrinking keeps the oldest bullets; the rest are dropped
+    int count = (field->count < capacity) ? field->count : capacity;
+    size_t floatBytes = count * sizeof(float);
+    memcpy(resized.x, field->x, floatBytes);
+    memcpy(resized.y, field->y, floatBytes);
+    memcpy(resized.vx, field->vx, floatBytes);
+    memcpy(resized.vy, field->vy, floatBytes);
+    memcpy(resized.width, field->width, floatBytes);
+    memcpy(resized.height, field->height, floatBytes);
+    memcpy(resized.color, field->color, count * sizeof(Color));
+    memcpy(resized.damage, field->damage, count);
+    resized.count = count;
+
+    UnloadBulletField(*field);
+    *field = resized;
+    return true;
+}
+
+void ClearBulletField(BulletField *field) {
+    field->count = 0;
+}
+
+bool SpawnBullet(BulletField *field, Rectangle rect, Vector2 velocity, Color color, int damage) {
+    if (field->count == field->capacity) return false;
+
+    int i = field->count++;
+    field->x[i] = rect.x;
+    field->y[i] = rect.y;
+    field->vx[i] = velocity.x;
+    field->vy[i] = velocity.y;
+    field->width[i] = rect.width;
+    field->height[i] = rect.height;
+    field->color[i] = color;
+    field->damage[i] = (unsigned char)damage;
+    return true;
+}
+
+void RemoveBullet(BulletField *field, int index) {
+    MoveBullet(field, index, --field->count);
+}
+
+void UpdateBulletField(BulletField *field, Rectangle bounds) {
+    int count = field->count;
+    float *restrict x = field->x;
+    float *restrict y = field->y;
+    const float *restrict vx = field->vx;
+    const float *restrict vy = field->vy;
+
+    // Branch-free, so this becomes packed adds
+    for (int i = 0; i < count; i++) {
+        x[i] += vx[i];
+        y[i] += vy[i];
+    }
+
+    float right = bounds.x + bounds.width;
+    float bottom = bounds.y + bounds.height;
+    for (int i = count - 1; i >= 0; i--) {
+        bool outside = (x[i] + field->width[i] < bounds.x) | (x[i] > right) |
+                       (y[i] + field->height[i] < bounds.y) | (y[i] > bottom);
+        if (outside) {
+            MoveBullet(field, i, --count);
+        }
+    }
+    field->count = count;
+}
+
+int CollideBulletField(BulletField *field, Rectangle hitbox, Vector2 hitboxMotion, const BitMask *mask, Vector2 maskPosition) {
+    int count = field->count;
+    int damage = 0;
+
+    // Sweep in the hitbox's frame of reference from where both were at the start of the frame
+    Rectangle start = { hitbox.x - hitboxMotion.x, hitbox.y - hitboxMotion.y, hitbox.width, hitbox.height };
+    Rectangle reach = {
+        fminf(start.x, hitbox.x), fminf(start.y, hitbox.y),
+        hitbox.width + fabsf(hitboxMotion.x), hitbox.height + fabsf(hitboxMotion.y)
+    };
+
+    for (int i = count - 1; i >= 0; i--) {
+        // Cheap reject against everything the hitbox and the bullet covered this frame
+        float minX = fminf(field->x[i], field->x[i] - field->vx[i]);
+        float minY = fminf(field->y[i], field->y[i] - field->vy[i]);
+        bool near = (minX < reach.x + reach.width) & (minX + field->width[i] + fabsf(field->vx[i]) > reach.x) &
+                    (minY < reach.y + reach.height) & (minY + field->height[i] + fabsf(field->vy[i]) > reach.y);
+        if (!near) continue;
+
+        Rectangle bullet = { field->x[i] - field->vx[i], field->y[i] - field->vy[i], field->width[i], field->height[i] };
+        Vector2 delta = { field->vx[i] - hitboxMotion.x, field->vy[i] - hitboxMotion.y };
+        float timeOfImpact;
+        if (!SweepRects(bullet, delta, start, &timeOfImpact)) continue;
+
+        // Narrow phase: the bullet's path relative to the hitbox, laid over the mask where it ended up
+        if (mask != NULL) {
+            Rectangle path = {
+                fminf(field->x[i], field->x[i] - delta.x), fminf(field->y[i], field->y[i] - delta.y),
+                field->width[i] + fabsf(delta.x), field->height[i] + fabsf(delta.y)
+            };
+            if (!MaskOverlapsRect(mask, (int)maskPosition.x, (int)maskPosition.y, GetCollisionRec(path, hitbox))) continue;
+        }
+        damage += field->damage[i];
+        MoveBullet(field, i, --count);
+    }
+
+    field->count = count;
+    return damage;
+}
+
+void DrawBulletField(const BulletField *field) {
+    // Plain quads share one texture, so raylib batches them into a handful of draw calls
+    for (int i = 0; i < field->count; i++) {
+        DrawRectangleRec((Rectangle){ field->x[i], field->y[i], field->width[i], field->height[i] }, field->color[i]);
+    }
+}
+
+bool SaveBulletField(const BulletField *field, Snapshot *snapshot) {
+    int count = field->count;
+    return WriteSnapshot(snapshot, &count, sizeof(int)) &&
+           WriteSnapshot(snapshot, field->x, count * sizeof(float)) &&
+           WriteSnapshot(snapshot, field->y, count * sizeof(float)) &&
+           WriteSnapshot(snapshot, field->vx, count * sizeof(float)) &&
+           WriteSnapshot(snapshot, field->vy, count * sizeof(float)) &&
+           WriteSnapshot(snapshot, field->width, count * sizeof(float)) &&
+           WriteSnapshot(snapshot, field->height, count * sizeof(float)) &&
+           WriteSnapshot(snapshot, field->color, count * sizeof(Color)) &&
+           WriteSnapshot(snapshot, field->damage, count);
+}
+
+bool RestoreBulletField(BulletField *field, Snapshot *snapshot) {
+    int count;
+    if (!ReadSnapshot(snapshot, &count, sizeof(int))) return false;
+    // Taken before the capacity was tuned down
+    if (count > field->capacity && !ResizeBulletField(field, count)) return false;
+
+    field->count = 0;
+    if (!ReadSnapshot(snapshot, field->x, count * sizeof(float)) ||
+        !ReadSnapshot(snapshot, field->y, count * sizeof(float)) ||
+        !ReadSnapshot(snapshot, field->vx, count * sizeof(float)) ||
+        !ReadSnapshot(snapshot, field->vy, count * sizeof(float)) ||
+        !ReadSnapshot(snapshot, field->width, count * sizeof(float)) ||
+        !ReadSnapshot(snapshot, field->height, count * sizeof(float)) ||
+        !ReadSnapshot(snapshot, field->color, count * sizeof(Color)) ||
+        !ReadSnapshot(snapshot, field->damage, count)) {
+        return false;
+    }
+    field->count = count;
+    return true;
+}
@@ -0,0 +1,43 @@
+#ifndef BULLETS_H
+#define BULLETS_H
+
+#include "raylib.h"
+#include "snapshot.h"
+#include "bitmask.h"
+
+// Enemy bullets kept outside the ECS as plain parallel arrays, so moving,
+// culling and hit-testing thousands of them are tight loops the compiler
+// can vectorise. Order is not preserved: removal moves the last bullet into the gap.
+typedef struct BulletField {
+    int count;
+    int capacity;
+    float *x;                // Top-left corner
+    float *y;
+    float *vx;               // Pixels per frame
+    float *vy;
+    float *width;
+    float *height;
+    Color *color;
+    unsigned char *damage;
+} BulletField;
+
+BulletField LoadBulletField(int capacity);
+void UnloadBulletField(BulletField field);
+// Moves the live bullets into storage for capacity; call between ticks
+bool ResizeBulletField(BulletField *field, int capacity);
+void ClearBulletField(BulletField *field);
+bool SpawnBullet(BulletField *field, Rectangle rect, Vector2 velocity, Color color, int damage);
+// Moves the last bullet into index
+void RemoveBullet(BulletField *field, int index);
+// Moves every bullet and drops the ones that left bounds
+void UpdateBulletField(BulletField *field, Rectangle bounds);
+// Removes the bullets whose path this frame crossed hitbox, which itself moved
+// by hitboxMotion, and returns the damage they deal. With a mask (top-left at
+// maskPosition) a path that reaches the hitbox must also cross a solid pixel.
+int CollideBulletField(BulletField *field, Rectangle hitbox, Vector2 hitboxMotion, const BitMask *mask, Vector2 maskPosition);
+void DrawBulletField(const BulletField *field);
+bool SaveBulletField(const BulletField *field, Snapshot *snapshot);
+// Grows the field when the snapshot holds more bullets than it fits
+bool RestoreBulletField(BulletField *field, Snapshot *snapshot);
+
+#endif
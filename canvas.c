@@ -0,0 +1,167 @@
+#include "canvas.h"
+#include <math.h>
+
+// Internal resolution of each dynamic resolution step, relative to the virtual size
+static const float resolutionScales[CANVAS_RESOLUTION_STEPS] = { 1.0f, 0.85f, 0.7f, 0.5f };
+
+// Hysteresis: drop quickly when over budget, climb back only after a long quiet stretch
+#define FRAMES_BEFORE_DOWNSCALE 30
+#define FRAMES_BEFORE_UPSCALE 180
+#define UPSCALE_HEADROOM 0.6f
+
+static void ApplyCanvasFilters(Canvas *canvas) {
+    for (int i = 0; i < CANVAS_RESOLUTION_STEPS; i++) {
+        // Reduced steps never map pixel-for-pixel, so they always need filtering
+        bool nearest = (i == 0 && canvas->scaleMode == CANVAS_SCALE_INTEGER);
+        SetTextureFilter(canvas->targets[i].texture, nearest ? TEXTURE_FILTER_POINT : TEXTURE_FILTER_BILINEAR);
+    }
+}
+
+static void UpdateCanvasViewport(Canvas *canvas) {
+    float screenWidth = GetScreenWidth();
+    float screenHeight = GetScreenHeight();
+    float scale = fminf(screenWidth / canvas->width, screenHeight / canvas->height);
+
+    // Integer scaling falls back to fit when the window is smaller than the canvas
+    if (canvas->scaleMode == CANVAS_SCALE_INTEGER && scale >= 1.0f) {
+        scale = floorf(scale);
+    }
+
+    canvas->viewport.width = canvas->width * scale;
+    canvas->viewport.height = canvas->height * scale;
+    canvas->viewport.x = floorf((screenWidth - canvas->viewport.width) / 2);
+    canvas->viewport.y = floorf((screenHeight - canvas->viewport.height) / 2);
+
+    // Mouse queries return virtual coordinates for the rest of the frame
+    SetMouseOffset(-canvas->viewport.x, -canvas->viewport.y);
+    SetMouseScale(canvas->width / canvas->viewport.width, canvas->height / canvas->viewport.height);
+}
+
+static void UpdateDynamicResolution(Canvas *canvas, float workTime) {
+    // A missed frame means the GPU or the swap stalled even if the CPU work was short
+    float load = workTime;
+    if (GetFrameTime() > canvas->frameBudget * 1.1f) load = GetFrameTime();
+    canvas->frameLoad = canvas->frameLoad * 0.9f + load * 0.1f;
+
+    if (!canvas->dynamicResolution) return;
+
+    if (canvas->frameLoad > canvas->frameBudget) {
+        canvas->framesUnderBudget = 0;
+        if (++canvas->framesOverBudget >= FRAMES_BEFORE_DOWNSCALE && canvas->level < CANVAS_RESOLUTION_STEPS - 1) {
+            canvas->level++;
+            canvas->framesOverBudget = 0;
+        }
+    } else if (canvas->frameLoad < canvas->frameBudget * UPSCALE_HEADROOM) {
+        canvas->framesOverBudget = 0;
+        if (++canvas->framesUnderBudget >= FRAMES_BEFORE_UPSCALE && canvas->level > 0) {
+            canvas->level--;
+            canvas->framesUnderBudget = 0;
+        }
+    } else {
+        canvas->framesOverBudget = 0;
+        canvas->framesUnderBudget = 0;
+    }
+}
+
+Canvas LoadCanvas(int width, int height, float frameBudget) {
+    Canvas canvas = { 0 };
+    canvas.width = width;
+    canvas.height = height;
+    canvas.scaleMode = CANVAS_SCALE_INTEGER;
+    canvas.dynamicResolution = true;
+    canvas.frameBudget = frameBudget;
+
+    for (int i = 0; i < CANVAS_RESOLUTION_STEPS; i++) {
+        canvas.targets[i] = LoadRenderTexture(width * resolutionScales[i], height * resolutionScales[i]);
+    }
+    ApplyCanvasFilters(&canvas);
+    UpdateCanvasViewport(&canvas);
+
+    canvas.frameStart = GetTime();
+    return canvas;
+}
+
+void UnloadCanvas(Canvas canvas) {
+    for (int i = 0; i < CANVAS_RESOLUTION_STEPS; i++) {
+        UnloadRenderTexture(canvas.targets[i]);
+    }
+}
+
+void SetCanvasScaleMode(Canvas *canvas, CanvasScaleMode mode) {
+    canvas->scaleMode = mode;
+    ApplyCanvasFilters(canvas);
+}
+
+float GetCanvasScale(const Canvas *canvas) {
+    return canvas->viewport.width / canvas->width;
+}
+
+void AddCanvasOverlay(Canvas *canvas, UiLayer *layer) {
+    if (canvas->overlayCount < CANVAS_MAX_OVERLAYS) {
+        canvas->overlays[canvas->overlayCount++] = layer;
+    }
+}
+
+void BeginCanvas(Canvas *canvas) {
+    UpdateCanvasViewport(canvas);
+
+    RenderTexture2D target = canvas->targets[canvas->level];
+    Camera2D camera = { 0 };
+    camera.zoom = (float)target.texture.width / canvas->width;
+
+    canvas->overlayCount = 0;
+    canvas->sceneOpen = true;
+    BeginTextureMode(target);
+    ClearBackground(BLACK);
+    BeginMode2D(camera);
+}
+
+void EndCanvasScene(Canvas *canvas) {
+    if (!canvas->sceneOpen) return;
+
+    EndMode2D();
+    EndTextureMode();
+    canvas->sceneOpen = false;
+    canvas->sceneOverlayCount = canvas->overlayCount;
+}
+
+static void CompositeCanvas(Canvas *canvas) {
+    // Overlay layers refresh their own render textures, which cannot nest inside the canvas pass
+    for (int i = 0; i < canvas->overlayCount; i++) {
+        UpdateUiLayer(canvas->overlays[i]);
+    }
+
+    BeginDrawing();
+    ClearBackground(BLACK);
+
+    RenderTexture2D target = canvas->targets[canvas->level];
+    Rectangle source = { 0, 0, target.texture.width, -target.texture.height };
+    DrawTexturePro(target.texture, source, canvas->viewport, (Vector2){ 0, 0 }, 0.0f, WHITE);
+
+    for (int i = 0; i < canvas->overlayCount; i++) {
+        Texture2D overlay = canvas->overlays[i]->target.texture;
+        DrawTexturePro(overlay, (Rectangle){ 0, 0, overlay.width, -overlay.height }, canvas->viewport, (Vector2){ 0, 0 }, 0.0f, WHITE);
+    }
+    canvas->overlayCount = canvas->sceneOverlayCount;
+
+    EndDrawing();
+}
+
+void EndCanvas(Canvas *canvas) {
+    EndCanvasScene(canvas);
+
+    float workTime = GetTime() - canvas->frameStart;
+    CompositeCanvas(canvas);
+
+    UpdateDynamicResolution(canvas, workTime);
+    canvas->frameStart = GetTime();
+}
+
+void PresentCanvas(Canvas *canvas) {
+    // The window may have been resized since the scene was drawn
+    UpdateCanvasViewport(canvas);
+    CompositeCanvas(canvas);
+
+    // A frame that redraws nothing says nothing about the scene's cost
+    canvas->frameStart = GetTime();
+}
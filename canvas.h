@@ -0,0 +1,49 @@
+#ifndef CANVAS_H
+#define CANVAS_H
+
+#include "raylib.h"
+#include "ui.h"
+
+#define CANVAS_RESOLUTION_STEPS 4
+#define CANVAS_MAX_OVERLAYS 4
+
+typedef enum CanvasScaleMode {
+    CANVAS_SCALE_INTEGER,    // Largest whole multiple that fits, nearest filtering
+    CANVAS_SCALE_FIT         // Fill the window keeping aspect ratio, bilinear filtering
+} CanvasScaleMode;
+
+// Fixed virtual-resolution render target that is upscaled to the window.
+// Everything is drawn in virtual coordinates; the mouse is remapped to match.
+typedef struct Canvas {
+    int width;
+    int height;
+    RenderTexture2D targets[CANVAS_RESOLUTION_STEPS];   // One per dynamic resolution step
+    int level;                                          // Current step, 0 is full resolution
+    CanvasScaleMode scaleMode;
+    bool dynamicResolution;
+    float frameBudget;                                  // Seconds of work allowed per frame
+    float frameLoad;                                    // Smoothed work time
+    double frameStart;
+    int framesOverBudget;
+    int framesUnderBudget;
+    Rectangle viewport;                                 // Where the canvas lands in the window
+    UiLayer *overlays[CANVAS_MAX_OVERLAYS];             // Composited at full resolution on top
+    int overlayCount;
+    int sceneOverlayCount;                              // Overlays added with the scene, kept while it is presented again
+    bool sceneOpen;
+} Canvas;
+
+Canvas LoadCanvas(int width, int height, float frameBudget);
+void UnloadCanvas(Canvas canvas);
+void BeginCanvas(Canvas *canvas);
+// Finishes the frame: closes the scene if still open, composites and presents it
+void EndCanvas(Canvas *canvas);
+// Closes the scene pass early so more overlays can be added before EndCanvas
+void EndCanvasScene(Canvas *canvas);
+// Presents the last scene again with its overlays plus any added since, without redrawing it
+void PresentCanvas(Canvas *canvas);
+void AddCanvasOverlay(Canvas *canvas, UiLayer *layer);
+void SetCanvasScaleMode(Canvas *canvas, CanvasScaleMode mode);
+float GetCanvasScale(const Canvas *canvas);
+
+#endif
@@ -0,0 +1,36 @@
+#include "collision.h"
+
+// Entry and exit times of a point moving from start by delta through [min, max] on one axis
+static bool SweepAxis(float start, float delta, float min, float max, float *enter, float *exit) {
+    if (delta == 0.0f) {
+        // Not moving on this axis: either always inside the slab or never
+        *enter = -1.0f;
+        *exit = 2.0f;
+        return start > min && start < max;
+    }
+
+    float t1 = (min - start) / delta;
+    float t2 = (max - start) / delta;
+    *enter = (t1 < t2) ? t1 : t2;
+    *exit = (t1 < t2) ? t2 : t1;
+    return true;
+}
+
+bool SweepRects(Rectangle moving, Vector2 delta, Rectangle target, float *timeOfImpact) {
+    // Grow the target by the moving box so only its corner has to be traced
+    float minX = target.x - moving.width;
+    float maxX = target.x + target.width;
+    float minY = target.y - moving.height;
+    float maxY = target.y + target.height;
+
+    float enterX, exitX, enterY, exitY;
+    if (!SweepAxis(moving.x, delta.x, minX, maxX, &enterX, &exitX)) return false;
+    if (!SweepAxis(moving.y, delta.y, minY, maxY, &enterY, &exitY)) return false;
+
+    float enter = (enterX > enterY) ? enterX : enterY;
+    float exit = (exitX < exitY) ? exitX : exitY;
+    if (enter >= exit || enter > 1.0f || exit <= 0.0f) return false;
+
+    *timeOfImpact = (enter > 0.0f) ? enter : 0.0f;
+    return true;
+}
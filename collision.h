@@ -0,0 +1,11 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include "raylib.h"
+
+// Swept AABB: moving starts at its position for this step and travels by delta.
+// Returns whether it touches target during the step and, if so, the time of
+// impact as a fraction of the step (0 when they already overlap at the start).
+bool SweepRects(Rectangle moving, Vector2 delta, Rectangle target, float *timeOfImpact);
+
+#endif
@@ -0,0 +1,133 @@
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+
+typedef enum ConfigFieldType {
+    CONFIG_INT,
+    CONFIG_FLOAT
+} ConfigFieldType;
+
+// Every tunable field by name; values below the minimum are rejected
+typedef struct ConfigField {
+    const char *name;
+    ConfigFieldType type;
+    size_t offset;
+    float minimum;
+} ConfigField;
+
+#define INT_FIELD(name, minimum) { #name, CONFIG_INT, offsetof(GameConfig, name), minimum }
+#define FLOAT_FIELD(name, minimum) { #name, CONFIG_FLOAT, offsetof(GameConfig, name), minimum }
+
+static const ConfigField configFields[] = {
+    INT_FIELD(screenWidth, 1),
+    INT_FIELD(screenHeight, 1),
+    FLOAT_FIELD(heavyBulletCooldown, 0),
+    FLOAT_FIELD(shooterCooldown, 0),
+    FLOAT_FIELD(bossShootCooldown, 0),
+    FLOAT_FIELD(bossSpawnCooldown, 0),
+    INT_FIELD(frameWidth, 1),
+    INT_FIELD(frameHeight, 1),
+    INT_FIELD(maxEnemies, 1),
+    INT_FIELD(maxWaves, 1),
+    INT_FIELD(maxEnemyBullets, 0),
+    INT_FIELD(maxBossBullets, 1),
+    FLOAT_FIELD(frameSpeed, 0.001f),
+    INT_FIELD(frameCount, 1),
+    FLOAT_FIELD(waveSpeed, 0),
+    FLOAT_FIELD(waveHeight, 0),
+    INT_FIELD(numWavePoints, 2),
+    INT_FIELD(numWaves, 0),
+    INT_FIELD(loopbackDelay, 0),
+    INT_FIELD(cavernRows, 1),
+    FLOAT_FIELD(cavernScrollSpeed, 0),
+};
+#define CONFIG_FIELD_COUNT ((int)(sizeof(configFields) / sizeof(configFields[0])))
+
+GameConfig DefaultGameConfig(void) {
+    return (GameConfig){
+        .screenWidth = 600,
+        .screenHeight = 800,
+        .heavyBulletCooldown = 3.0f,
+        .shooterCooldown = 1.5f,
+        .bossShootCooldown = 0.5f,
+        .bossSpawnCooldown = 5.0f,
+        .frameWidth = 64,
+        .frameHeight = 64,
+        .maxEnemies = 50,
+        .maxWaves = 5,
+        .maxEnemyBullets = 50,
+        .maxBossBullets = 8192,      // Bullet field capacity; boss patterns can fill thousands
+        .frameSpeed = 0.1f,
+        .frameCount = 1,
+        .waveTime = 0.0f,
+        .waveSpeed = 2.0f,
+        .waveHeight = 20.0f,
+        .numWavePoints = 30,
+        .numWaves = 5,
+        .loopbackDelay = 4,          // Ticks the second submarine's input is held back
+        .cavernRows = 400,           // Cavern level length in tiles
+        .cavernScrollSpeed = 40.0f,  // Pixels per second
+    };
+}
+
+static const ConfigField *FindConfigField(const char *name) {
+    for (int i = 0; i < CONFIG_FIELD_COUNT; i++) {
+        if (strcmp(configFields[i].name, name) == 0) return &configFields[i];
+    }
+    return NULL;
+}
+
+bool LoadGameConfig(const char *fileName, GameConfig *config) {
+    FILE *file = fopen(fileName, "r");
+    if (file == NULL) return false;
+
+    char line[256];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        lineNumber++;
+        char name[64];
+        float value;
+        if (line[strspn(line, " \t\r\n")] == '\0' || line[strspn(line, " \t")] == '#') continue;
+        if (sscanf(line, " %63[A-Za-z0-9_] = %f", name, &value) != 2) {
+            printf("%s:%d: expected name = value\n", fileName, lineNumber);
+            continue;
+        }
+
+        const ConfigField *field = FindConfigField(name);
+        if (field == NULL) {
+            printf("%s:%d: unknown setting %s\n", fileName, lineNumber, name);
+            continue;
+        }
+        if (value < field->minimum) {
+            printf("%s:%d: %s must be at least %g\n", fileName, lineNumber, name, field->minimum);
+            continue;
+        }
+
+        char *target = (char *)config + field->offset;
+        if (field->type == CONFIG_INT) {
+            *(int *)target = (int)value;
+        } else {
+            *(float *)target = value;
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+bool SaveGameConfig(const char *fileName, const GameConfig *config) {
+    FILE *file = fopen(fileName, "w");
+    if (file == NULL) return false;
+
+    bool ok = fprintf(file, "# Game tuning, one name = value per line. Saved changes apply while the game runs.\n") >= 0;
+    for (int i = 0; ok && i < CONFIG_FIELD_COUNT; i++) {
+        const ConfigField *field = &configFields[i];
+        const char *source = (const char *)config + field->offset;
+        if (field->type == CONFIG_INT) {
+            ok = fprintf(file, "%s = %d\n", field->name, *(const int *)source) >= 0;
+        } else {
+            ok = fprintf(file, "%s = %g\n", field->name, *(const float *)source) >= 0;
+        }
+    }
+    return fclose(file) == 0 && ok;
+}
@@ -0,0 +1,38 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdbool.h>
+
+typedef struct GameConfig {
+    int screenWidth;
+    int screenHeight;
+    float heavyBulletCooldown;
+    float shooterCooldown;
+    float bossShootCooldown;
+    float bossSpawnCooldown;
+    int frameWidth;
+    int frameHeight;
+    int maxEnemies;
+    int maxWaves;
+    int maxEnemyBullets;
+    int maxBossBullets;
+    float frameSpeed;
+    int frameCount;
+    float waveTime;
+    float waveSpeed;
+    int waveHeight;
+    int numWavePoints;
+    int numWaves;
+    int loopbackDelay;
+    int cavernRows;
+    float cavernScrollSpeed;
+} GameConfig;
+
+// The values the game ships with; the window and the training library both start from these
+GameConfig DefaultGameConfig(void);
+// Overrides the fields named in a "name = value" text file; anything missing,
+// unknown or out of range keeps its current value
+bool LoadGameConfig(const char *fileName, GameConfig *config);
+bool SaveGameConfig(const char *fileName, const GameConfig *config);
+
+#endif
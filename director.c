@@ -0,0 +1,81 @@
+#include "director.h"
+#include <math.h>
+
+#define DIRECTOR_BASE_ENEMIES 5.0f
+#define DIRECTOR_TARGET_PACE 0.5f        // Kills per second a comfortable player manages
+#define DIRECTOR_IDLE_ENTITIES 4         // At or below this, a frame's load counts as the fixed cost
+#define DIRECTOR_MEASURE_ENTITIES 16     // From this many, the extra load is spread over them
+#define DIRECTOR_MAX_INTENSITY 40.0f
+#define DIRECTOR_MAX_SPEED 6.0f
+
+static float Clamp(float value, float min, float max) {
+    return (value < min) ? min : (value > max) ? max : value;
+}
+
+SpawnDirector CreateSpawnDirector(float frameBudget) {
+    return (SpawnDirector){
+        .frameBudget = frameBudget,
+        .idleLoad = -1.0f,
+        .intensity = 1.0f,
+        .capacity = DIRECTOR_MIN_ENEMIES * 2,
+    };
+}
+
+void RestartSpawnDirector(SpawnDirector *director) {
+    director->intensity = 1.0f;
+    director->capacity = DIRECTOR_MIN_ENEMIES * 2;
+}
+
+void ObserveFrameLoad(SpawnDirector *director, int enemies, int bullets, float frameLoad) {
+    int entities = enemies + bullets;
+
+    if (entities <= DIRECTOR_IDLE_ENTITIES) {
+        director->idleLoad = (director->idleLoad < 0) ? frameLoad : director->idleLoad * 0.95f + frameLoad * 0.05f;
+        return;
+    }
+    if (enemies > 0) {
+        director->bulletsPerEnemy = director->bulletsPerEnemy * 0.99f + ((float)bullets / enemies) * 0.01f;
+    }
+    if (director->idleLoad < 0 || entities < DIRECTOR_MEASURE_ENTITIES) return;
+
+    // Spikes smooth out; a cost that only ever rose would throttle the game for good after one hitch
+    float sample = fmaxf(frameLoad - director->idleLoad, 0.0f) / entities;
+    director->entityCost = (director->entityCost == 0.0f) ? sample : director->entityCost * 0.98f + sample * 0.02f;
+}
+
+int GetDirectorCapacity(const SpawnDirector *director) {
+    // Until the cost is known, probe upwards by doubling what the last wave had
+    if (director->entityCost <= 0.0f || director->idleLoad < 0) return director->capacity * 2;
+
+    float headroom = director->frameBudget * DIRECTOR_TARGET_LOAD - director->idleLoad;
+    int entities = (int)(headroom / director->entityCost);
+    int enemies = (int)(entities / (1.0f + director->bulletsPerEnemy));
+    return (enemies > DIRECTOR_MIN_ENEMIES) ? enemies : DIRECTOR_MIN_ENEMIES;
+}
+
+WaveMix PlanEndlessWave(SpawnDirector *director, int wave, int difficulty, WaveReport report) {
+    // Fast, healthy clears push harder; slow or costly ones ease off
+    if (report.enemies > 0) {
+        float pace = report.enemies / fmaxf(report.duration, 1.0f);
+        float paceScore = Clamp(pace / DIRECTOR_TARGET_PACE - 1.0f, -0.5f, 0.5f);
+        float healthScore = report.healthFraction - 0.5f;
+        director->intensity *= 1.05f + 0.5f * (paceScore + healthScore);
+        director->intensity = Clamp(director->intensity, 0.5f, DIRECTOR_MAX_INTENSITY);
+    }
+
+    int enemies = (int)(DIRECTOR_BASE_ENEMIES * director->intensity);
+    int capacity = GetDirectorCapacity(director);
+    if (enemies > capacity) enemies = capacity;
+    if (enemies < DIRECTOR_MIN_ENEMIES) enemies = DIRECTOR_MIN_ENEMIES;
+    if (enemies > DIRECTOR_MAX_ENEMIES) enemies = DIRECTOR_MAX_ENEMIES;
+    director->capacity = enemies;
+
+    // More shooters and hunters as pressure builds, each kind capped at two fifths
+    WaveMix mix = { 0 };
+    mix.shooters = (int)(enemies * fminf(0.05f * director->intensity, 0.4f));
+    mix.chasers = (int)(enemies * fminf(0.1f + 0.05f * director->intensity, 0.4f));
+    mix.patrollers = enemies - mix.shooters - mix.chasers;
+    mix.health = 1 + wave / 3;
+    mix.speed = fminf(difficulty + 0.1f * wave, DIRECTOR_MAX_SPEED);
+    return mix;
+}
@@ -0,0 +1,46 @@
+#ifndef DIRECTOR_H
+#define DIRECTOR_H
+
+#define DIRECTOR_TARGET_LOAD 0.8f        // Share of the frame budget the director plans to fill
+#define DIRECTOR_MIN_ENEMIES 4
+#define DIRECTOR_MAX_ENEMIES 200         // No plan asks for more; the world is sized for this many at load
+
+// How many of each enemy kind a wave has, and how tough they are
+typedef struct WaveMix {
+    int patrollers;
+    int chasers;
+    int shooters;
+    int health;
+    float speed;
+} WaveMix;
+
+// How the players did in the wave that just ended
+typedef struct WaveReport {
+    int enemies;
+    float duration;                      // Seconds from spawn to the last kill
+    float healthFraction;                // Average over the submarines still alive, 0 to 1
+} WaveReport;
+
+// Plans endless-mode waves. Pressure follows the players: it rises while
+// they clear waves quickly and healthily and eases off when they struggle.
+// Size follows the machine: the director learns what each live entity
+// costs in frame time and never plans more than fits the frame budget.
+typedef struct SpawnDirector {
+    float frameBudget;
+    float idleLoad;                      // Smoothed frame work with almost nothing alive; < 0 until seen
+    float entityCost;                    // Smoothed extra frame work per live enemy or bullet; 0 until measured
+    float bulletsPerEnemy;               // Smoothed, so a planned enemy counts with the bullets it brings
+    float intensity;
+    int capacity;                        // Enemies the last plan allowed for
+} SpawnDirector;
+
+SpawnDirector CreateSpawnDirector(float frameBudget);
+// New run: pressure starts over, what was learned about the machine is kept
+void RestartSpawnDirector(SpawnDirector *director);
+// Called every frame with that frame's measured work time
+void ObserveFrameLoad(SpawnDirector *director, int enemies, int bullets, float frameLoad);
+// Enemies a wave may have without pushing the frame past its budget
+int GetDirectorCapacity(const SpawnDirector *director);
+WaveMix PlanEndlessWave(SpawnDirector *director, int wave, int difficulty, WaveReport report);
+
+#endif
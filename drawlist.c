@@ -0,0 +1,108 @@
+#include "drawlist.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+DrawList LoadDrawList(int capacity) {
+    return (DrawList){ .capacity = capacity };
+}
+
+void BeginDrawList(DrawList *list, Rectangle view, Arena *arena) {
+    list->arena = arena;
+    list->items = ArenaAlloc(arena, list->capacity * sizeof(DrawItem));
+    list->count = 0;
+    list->view = view;
+    list->submitted = 0;
+    list->culled = 0;
+    list->duplicates = 0;
+    list->textureSwitches = 0;
+    list->dropped = 0;
+}
+
+// Area the item can touch; a rotated quad is bounded by a square around its pivot
+static Rectangle GetItemBounds(const DrawItem *item) {
+    if (item->rotation == 0.0f) return item->dest;
+    float reach = fmaxf(item->dest.width, item->dest.height);
+    return (Rectangle){ item->dest.x - reach, item->dest.y - reach, reach * 2, reach * 2 };
+}
+
+static void SubmitItem(DrawList *list, DrawItem item) {
+    item.sequence = list->submitted++;
+    if (!CheckCollisionRecs(GetItemBounds(&item), list->view)) {
+        list->culled++;
+        return;
+    }
+
+    // Grow geometrically so the list settles at the busiest frame's size; the
+    // outgrown block stays in the arena until its reset
+    if (list->items == NULL || list->count == list->capacity) {
+        int capacity = (list->items == NULL) ? list->capacity : list->capacity * 2;
+        if (capacity < 64) capacity = 64;
+        DrawItem *items = ArenaAlloc(list->arena, capacity * sizeof(DrawItem));
+        if (items == NULL) {
+            list->dropped++;
+            return;
+        }
+        if (list->count > 0) memcpy(items, list->items, list->count * sizeof(DrawItem));
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = item;
+}
+
+void SubmitSprite(DrawList *list, int layer, Texture2D texture, Rectangle source, Rectangle dest, float rotation, Color tint) {
+    SubmitItem(list, (DrawItem){
+        .layer = layer, .texture = texture, .source = source, .dest = dest, .rotation = rotation, .tint = tint, .sequence = 0
+    });
+}
+
+void SubmitRect(DrawList *list, int layer, Rectangle rect, Color color) {
+    SubmitItem(list, (DrawItem){ .layer = layer, .dest = rect, .tint = color, .sequence = 0 });
+}
+
+// Layer, then texture, then position, so identical items end up next to each other.
+// Items at the same spot keep their submission order (a bar's fill goes over its frame).
+static int CompareItems(const void *a, const void *b) {
+    const DrawItem *left = a;
+    const DrawItem *right = b;
+    if (left->layer != right->layer) return (left->layer < right->layer) ? -1 : 1;
+    if (left->texture.id != right->texture.id) return (left->texture.id < right->texture.id) ? -1 : 1;
+    if (left->dest.y != right->dest.y) return (left->dest.y < right->dest.y) ? -1 : 1;
+    if (left->dest.x != right->dest.x) return (left->dest.x < right->dest.x) ? -1 : 1;
+    return (left->sequence < right->sequence) ? -1 : (left->sequence > right->sequence);
+}
+
+static bool SameRect(Rectangle a, Rectangle b) {
+    return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+static bool SameItem(const DrawItem *a, const DrawItem *b) {
+    return a->layer == b->layer && a->texture.id == b->texture.id &&
+           SameRect(a->source, b->source) && SameRect(a->dest, b->dest) && a->rotation == b->rotation &&
+           a->tint.r == b->tint.r && a->tint.g == b->tint.g && a->tint.b == b->tint.b && a->tint.a == b->tint.a;
+}
+
+void FlushDrawList(DrawList *list) {
+    if (list->count == 0) return;
+    qsort(list->items, list->count, sizeof(DrawItem), CompareItems);
+
+    unsigned int boundTexture = 0;
+    for (int i = 0; i < list->count; i++) {
+        const DrawItem *item = &list->items[i];
+        if (i > 0 && SameItem(item, &list->items[i - 1])) {
+            list->duplicates++;
+            continue;
+        }
+        if (item->texture.id != boundTexture) {
+            boundTexture = item->texture.id;
+            list->textureSwitches++;
+        }
+
+        if (item->texture.id == 0) {
+            DrawRectangleRec(item->dest, item->tint);
+        } else {
+            DrawTexturePro(item->texture, item->source, item->dest, (Vector2){ 0, 0 }, item->rotation, item->tint);
+        }
+    }
+    list->count = 0;
+}
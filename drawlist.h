@@ -0,0 +1,57 @@
+#ifndef DRAWLIST_H
+#define DRAWLIST_H
+
+#include "raylib.h"
+#include "arena.h"
+
+// Later layers draw over earlier ones
+typedef enum DrawLayer {
+    LAYER_BACKGROUND,
+    LAYER_TERRAIN,
+    LAYER_ENEMIES,
+    LAYER_PROJECTILES,
+    LAYER_PLAYERS,
+    LAYER_OVERLAY
+} DrawLayer;
+
+// One quad waiting to be drawn; a texture id of 0 draws a solid rectangle
+typedef struct DrawItem {
+    int layer;
+    Texture2D texture;
+    Rectangle source;
+    Rectangle dest;
+    float rotation;              // Degrees, about the top-left corner of dest
+    Color tint;
+    int sequence;                // Submission order, to break ties
+} DrawItem;
+
+// Sprites are collected during rendering instead of drawn immediately, then
+// culled against the view, sorted by layer and texture so each texture is
+// bound once per layer, and submitted without repeats. Order within a layer
+// and texture is by position, then submission. Items live in the frame
+// arena; capacity carries over, so a frame reserves the busiest one's size.
+typedef struct DrawList {
+    DrawItem *items;
+    int count;
+    int capacity;
+    Rectangle view;
+    Arena *arena;
+
+    // Last flush, to see what the stage saved
+    int submitted;
+    int culled;
+    int duplicates;
+    int textureSwitches;
+    int dropped;                 // Items the arena had no room for
+} DrawList;
+
+DrawList LoadDrawList(int capacity);
+// Empties the list and takes its storage from arena, which must outlive the
+// flush; items entirely outside view are dropped as they are submitted
+void BeginDrawList(DrawList *list, Rectangle view, Arena *arena);
+void SubmitSprite(DrawList *list, int layer, Texture2D texture, Rectangle source, Rectangle dest, float rotation, Color tint);
+void SubmitRect(DrawList *list, int layer, Rectangle rect, Color color);
+// Sorts, removes duplicates and draws everything submitted since BeginDrawList
+void FlushDrawList(DrawList *list);
+
+#endif
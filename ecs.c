@@ -0,0 +1,312 @@
+#include "ecs.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Bytes per row for each component column; tags have no column
+static const size_t componentSizes[COMPONENT_COUNT] = {
+    [COMPONENT_TRANSFORM] = sizeof(Transform),
+    [COMPONENT_VELOCITY] = sizeof(Velocity),
+    [COMPONENT_HEALTH] = sizeof(Health),
+    [COMPONENT_SHOOTER] = sizeof(Shooter),
+    [COMPONENT_PROJECTILE] = sizeof(Projectile),
+    [COMPONENT_SPRITE] = sizeof(Sprite),
+    [COMPONENT_PLAYER] = sizeof(Player),
+    [COMPONENT_ENEMY] = sizeof(Enemy),
+    [COMPONENT_BOSS] = 0,
+    [COMPONENT_EMITTER] = sizeof(Emitter),
+    [COMPONENT_STEERING] = sizeof(Steering),
+};
+
+static bool GrowArchetype(Archetype *archetype, int capacity) {
+    Entity *entities = realloc(archetype->entities, capacity * sizeof(Entity));
+    if (entities == NULL) return false;
+    archetype->entities = entities;
+
+    for (int type = 0; type < COMPONENT_COUNT; type++) {
+        if (!(archetype->mask & COMPONENT_BIT(type)) || componentSizes[type] == 0) continue;
+        void *column = realloc(archetype->columns[type], capacity * componentSizes[type]);
+        if (column == NULL) return false;
+        archetype->columns[type] = column;
+    }
+
+    archetype->capacity = capacity;
+    return true;
+}
+
+static int FindArchetype(World *world, ComponentMask mask) {
+    for (int i = 0; i < world->archetypeCount; i++) {
+        if (world->archetypes[i].mask == mask) return i;
+    }
+
+    if (world->archetypeCount == ECS_MAX_ARCHETYPES) return -1;
+    Archetype *archetype = &world->archetypes[world->archetypeCount];
+    memset(archetype, 0, sizeof(*archetype));
+    archetype->mask = mask;
+    return world->archetypeCount++;
+}
+
+static int EntityIndex(Entity entity) {
+    return (int)(entity & ECS_INDEX_MASK);
+}
+
+static Entity MakeEntity(int index, unsigned int generation) {
+    return (generation << ECS_INDEX_BITS) | (unsigned int)index;
+}
+
+World *LoadWorld(int capacity) {
+    if (capacity <= 0 || capacity > (int)ECS_INDEX_MASK) return NULL;
+
+    World *world = calloc(1, sizeof(World));
+    if (world == NULL) return NULL;
+
+    world->slots = malloc(capacity * sizeof(EntitySlot));
+    if (world->slots == NULL) {
+        free(world);
+        return NULL;
+    }
+
+    // Thread every slot onto the free list
+    world->capacity = capacity;
+    for (int i = 0; i < capacity; i++) {
+        world->slots[i] = (EntitySlot){ .archetype = -1, .row = i + 1, .generation = 0 };
+    }
+    world->slots[capacity - 1].row = -1;
+    world->freeHead = 0;
+    return world;
+}
+
+// Threads slots [first, last) onto the front of the free list
+static void FreeSlots(World *world, int first, int last) {
+    for (int i = last - 1; i >= first; i--) {
+        world->slots[i].archetype = -1;
+        world->slots[i].row = world->freeHead;
+        world->freeHead = i;
+    }
+}
+
+bool GrowWorld(World *world, int capacity) {
+    if (capacity <= world->capacity) return true;
+    if (capacity > (int)ECS_INDEX_MASK) return false;
+
+    EntitySlot *slots = realloc(world->slots, capacity * sizeof(EntitySlot));
+    if (slots == NULL) return false;
+    world->slots = slots;
+
+    for (int i = world->capacity; i < capacity; i++) {
+        world->slots[i].generation = 0;
+    }
+    FreeSlots(world, world->capacity, capacity);
+    world->capacity = capacity;
+    return true;
+}
+
+void UnloadWorld(World *world) {
+    if (world == NULL) return;
+
+    for (int i = 0; i < world->archetypeCount; i++) {
+        Archetype *archetype = &world->archetypes[i];
+        free(archetype->entities);
+        for (int type = 0; type < COMPONENT_COUNT; type++) {
+            free(archetype->columns[type]);
+        }
+    }
+    free(world->slots);
+    free(world);
+}
+
+void ClearWorld(World *world) {
+    // Archetypes keep their storage so the next level does not reallocate
+    for (int i = 0; i < world->archetypeCount; i++) {
+        Archetype *archetype = &world->archetypes[i];
+        while (archetype->count > 0) {
+            DespawnEntity(world, archetype->entities[archetype->count - 1]);
+        }
+    }
+}
+
+void ReserveEntities(World *world, ComponentMask mask, int count) {
+    int index = FindArchetype(world, mask);
+    if (index < 0) return;
+
+    Archetype *archetype = &world->archetypes[index];
+    if (count > archetype->capacity) {
+        GrowArchetype(archetype, count);
+    }
+}
+
+bool SaveWorld(const World *world, Snapshot *snapshot) {
+    if (!WriteSnapshot(snapshot, &world->capacity, sizeof(int)) ||
+        !WriteSnapshot(snapshot, &world->freeHead, sizeof(int)) ||
+        !WriteSnapshot(snapshot, &world->entityCount, sizeof(int)) ||
+        !WriteSnapshot(snapshot, &world->archetypeCount, sizeof(int)) ||
+        !WriteSnapshot(snapshot, world->slots, world->capacity * sizeof(EntitySlot))) {
+        return false;
+    }
+
+    // Only live rows; reserved but unused storage is not part of the state
+    for (int i = 0; i < world->archetypeCount; i++) {
+        const Archetype *archetype = &world->archetypes[i];
+        if (!WriteSnapshot(snapshot, &archetype->mask, sizeof(ComponentMask)) ||
+            !WriteSnapshot(snapshot, &archetype->count, sizeof(int)) ||
+            !WriteSnapshot(snapshot, archetype->entities, archetype->count * sizeof(Entity))) {
+            return false;
+        }
+        for (int type = 0; type < COMPONENT_COUNT; type++) {
+            if (archetype->columns[type] == NULL) continue;
+            if (!WriteSnapshot(snapshot, archetype->columns[type], archetype->count * componentSizes[type])) return false;
+        }
+    }
+    return true;
+}
+
+bool RestoreWorld(World *world, Snapshot *snapshot) {
+    int capacity, freeHead, entityCount, archetypeCount;
+    if (!ReadSnapshot(snapshot, &capacity, sizeof(int)) ||
+        !ReadSnapshot(snapshot, &freeHead, sizeof(int)) ||
+        !ReadSnapshot(snapshot, &entityCount, sizeof(int)) ||
+        !ReadSnapshot(snapshot, &archetypeCount, sizeof(int))) {
+        return false;
+    }
+    // Archetypes are never removed, so an older snapshot's list is a prefix of the current one
+    if (archetypeCount > world->archetypeCount) return false;
+    if (capacity > world->capacity && !GrowWorld(world, capacity)) return false;
+    if (!ReadSnapshot(snapshot, world->slots, capacity * sizeof(EntitySlot))) return false;
+
+    // Slots the snapshot's world did not have yet go back on its free list, a
+    // generation on so no handle from after the snapshot can reach them
+    world->freeHead = freeHead;
+    world->entityCount = entityCount;
+    for (int i = capacity; i < world->capacity; i++) {
+        world->slots[i].generation = (world->slots[i].generation + 1) & (0xFFFFFFFFu >> ECS_INDEX_BITS);
+    }
+    FreeSlots(world, capacity, world->capacity);
+    for (int i = 0; i < world->archetypeCount; i++) {
+        Archetype *archetype = &world->archetypes[i];
+        archetype->count = 0;
+        if (i >= archetypeCount) continue;
+
+        ComponentMask mask;
+        int count;
+        if (!ReadSnapshot(snapshot, &mask, sizeof(ComponentMask)) || mask != archetype->mask) return false;
+        if (!ReadSnapshot(snapshot, &count, sizeof(int))) return false;
+        if (count > archetype->capacity && !GrowArchetype(archetype, count)) return false;
+
+        if (!ReadSnapshot(snapshot, archetype->entities, count * sizeof(Entity))) return false;
+        for (int type = 0; type < COMPONENT_COUNT; type++) {
+            if (archetype->columns[type] == NULL) continue;
+            if (!ReadSnapshot(snapshot, archetype->columns[type], count * componentSizes[type])) return false;
+        }
+        archetype->count = count;
+    }
+    return true;
+}
+
+Entity SpawnEntity(World *world, ComponentMask mask) {
+    int index = (world->freeHead < 0) ? -1 : FindArchetype(world, mask);
+    if (index < 0 || world->archetypes[index].count == world->archetypes[index].capacity) {
+        world->refusedSpawns++;
+        return ECS_INVALID_ENTITY;
+    }
+
+    Archetype *archetype = &world->archetypes[index];
+
+    int slotIndex = world->freeHead;
+    EntitySlot *slot = &world->slots[slotIndex];
+    world->freeHead = slot->row;
+    Entity entity = MakeEntity(slotIndex, slot->generation);
+
+    int row = archetype->count++;
+    archetype->entities[row] = entity;
+    for (int type = 0; type < COMPONENT_COUNT; type++) {
+        if (archetype->columns[type] != NULL) {
+            memset((char *)archetype->columns[type] + row * componentSizes[type], 0, componentSizes[type]);
+        }
+    }
+
+    slot->archetype = index;
+    slot->row = row;
+    world->entityCount++;
+    return entity;
+}
+
+void DespawnEntity(World *world, Entity entity) {
+    if (!IsEntityAlive(world, entity)) return;
+
+    int slotIndex = EntityIndex(entity);
+    EntitySlot *slot = &world->slots[slotIndex];
+    Archetype *archetype = &world->archetypes[slot->archetype];
+    int last = --archetype->count;
+
+    if (slot->row != last) {
+        Entity moved = archetype->entities[last];
+        archetype->entities[slot->row] = moved;
+        for (int type = 0; type < COMPONENT_COUNT; type++) {
+            if (archetype->columns[type] == NULL) continue;
+            char *column = archetype->columns[type];
+            memcpy(column + slot->row * componentSizes[type], column + last * componentSizes[type], componentSizes[type]);
+        }
+        world->slots[EntityIndex(moved)].row = slot->row;
+    }
+
+    // Bumping the generation invalidates every handle still pointing at this slot
+    slot->archetype = -1;
+    slot->generation = (slot->generation + 1) & (0xFFFFFFFFu >> ECS_INDEX_BITS);
+    slot->row = world->freeHead;
+    world->freeHead = slotIndex;
+    world->entityCount--;
+}
+
+bool IsEntityAlive(const World *world, Entity entity) {
+    int index = EntityIndex(entity);
+    if (entity == ECS_INVALID_ENTITY || index >= world->capacity) return false;
+
+    const EntitySlot *slot = &world->slots[index];
+    return slot->archetype >= 0 && MakeEntity(index, slot->generation) == entity;
+}
+
+bool HasComponent(const World *world, Entity entity, ComponentType type) {
+    if (!IsEntityAlive(world, entity)) return false;
+    return (world->archetypes[world->slots[EntityIndex(entity)].archetype].mask & COMPONENT_BIT(type)) != 0;
+}
+
+void *GetComponent(World *world, Entity entity, ComponentType type) {
+    if (!IsEntityAlive(world, entity)) return NULL;
+
+    EntitySlot *slot = &world->slots[EntityIndex(entity)];
+    Archetype *archetype = &world->archetypes[slot->archetype];
+    if (archetype->columns[type] == NULL) return NULL;
+    return (char *)archetype->columns[type] + slot->row * componentSizes[type];
+}
+
+int QueryArchetypes(World *world, ComponentMask include, ComponentMask exclude, Archetype **out, int maxOut) {
+    int count = 0;
+    for (int i = 0; i < world->archetypeCount && count < maxOut; i++) {
+        ComponentMask mask = world->archetypes[i].mask;
+        if ((mask & include) == include && (mask & exclude) == 0) {
+            out[count++] = &world->archetypes[i];
+        }
+    }
+    return count;
+}
+
+int CountEntities(World *world, ComponentMask include, ComponentMask exclude) {
+    Archetype *matches[ECS_MAX_ARCHETYPES];
+    int matchCount = QueryArchetypes(world, include, exclude, matches, ECS_MAX_ARCHETYPES);
+
+    int count = 0;
+    for (int i = 0; i < matchCount; i++) {
+        count += matches[i]->count;
+    }
+    return count;
+}
+
+void DespawnMatching(World *world, ComponentMask include, ComponentMask exclude) {
+    Archetype *matches[ECS_MAX_ARCHETYPES];
+    int matchCount = QueryArchetypes(world, include, exclude, matches, ECS_MAX_ARCHETYPES);
+
+    for (int i = 0; i < matchCount; i++) {
+        for (int row = matches[i]->count - 1; row >= 0; row--) {
+            DespawnEntity(world, matches[i]->entities[row]);
+        }
+    }
+}
@@ -0,0 +1,173 @@
+#ifndef ECS_H
+#define ECS_H
+
+#include "raylib.h"
+#include "pattern.h"
+#include "snapshot.h"
+
+#define ECS_MAX_ARCHETYPES 32
+#define ECS_INDEX_BITS 20                        // Up to about a million live entities
+#define ECS_INDEX_MASK ((1u << ECS_INDEX_BITS) - 1)
+#define ECS_INVALID_ENTITY ((Entity)0xFFFFFFFFu)
+#define PROJECTILE_MAX_PIERCE 4  // Most targets one projectile can hit
+
+// Handle: slot index in the low bits, the slot's generation above them. A
+// handle kept after its entity was despawned no longer matches and reads as dead.
+typedef unsigned int Entity;
+
+typedef enum ComponentType {
+    COMPONENT_TRANSFORM,
+    COMPONENT_VELOCITY,
+    COMPONENT_HEALTH,
+    COMPONENT_SHOOTER,
+    COMPONENT_PROJECTILE,
+    COMPONENT_SPRITE,
+    COMPONENT_PLAYER,
+    COMPONENT_ENEMY,
+    COMPONENT_BOSS,          // Tag, no data
+    COMPONENT_EMITTER,
+    COMPONENT_STEERING,
+    COMPONENT_COUNT
+} ComponentType;
+
+typedef unsigned int ComponentMask;
+
+#define COMPONENT_BIT(type) (1u << (type))
+#define HAS_TRANSFORM COMPONENT_BIT(COMPONENT_TRANSFORM)
+#define HAS_VELOCITY COMPONENT_BIT(COMPONENT_VELOCITY)
+#define HAS_HEALTH COMPONENT_BIT(COMPONENT_HEALTH)
+#define HAS_SHOOTER COMPONENT_BIT(COMPONENT_SHOOTER)
+#define HAS_PROJECTILE COMPONENT_BIT(COMPONENT_PROJECTILE)
+#define HAS_SPRITE COMPONENT_BIT(COMPONENT_SPRITE)
+#define HAS_PLAYER COMPONENT_BIT(COMPONENT_PLAYER)
+#define HAS_ENEMY COMPONENT_BIT(COMPONENT_ENEMY)
+#define HAS_BOSS COMPONENT_BIT(COMPONENT_BOSS)
+#define HAS_EMITTER COMPONENT_BIT(COMPONENT_EMITTER)
+#define HAS_STEERING COMPONENT_BIT(COMPONENT_STEERING)
+
+typedef struct Transform {
+    Rectangle rect;
+} Transform;
+
+// Pixels per frame; entities without a Projectile bounce off the screen edges
+typedef struct Velocity {
+    Vector2 value;
+} Velocity;
+
+typedef struct Health {
+    int current;
+    int max;
+} Health;
+
+typedef struct Shooter {
+    float cooldown;
+    float timer;
+    Vector2 bulletSize;
+    float bulletSpeed;
+} Shooter;
+
+// Projectiles are removed when they leave the screen instead of bouncing
+typedef struct Projectile {
+    int damage;
+    int owner;                       // Slot of the submarine that fired it
+    int pierce;                      // Targets it can still hit; spent at zero
+    int hitCount;
+    Entity hits[PROJECTILE_MAX_PIERCE];  // Enemies already damaged, so each is hit once
+} Projectile;
+
+typedef enum SpriteSheet {
+    SPRITE_SUBMARINE,
+    SPRITE_ENEMY,            // Front and back views, animated by distance travelled
+    SPRITE_ENEMY_FRONT,      // Front view only, for shooters and the boss
+    SPRITE_ROCKET,
+    SPRITE_SOLID             // Plain rectangle in the tint colour
+} SpriteSheet;
+
+typedef struct Sprite {
+    SpriteSheet sheet;
+    Color tint;
+    bool flipX;
+    int frame;
+    float frameTime;
+    float animDistance;
+} Sprite;
+
+typedef struct Player {
+    float speed;             // Pixels per second
+    float energy;
+    Vector2 hitboxSize;      // Centred on the sprite, 20 pixels below its top edge
+    Vector2 motion;          // Distance moved this frame, for swept collision
+    float specialTimer;      // Seconds until the special attack is ready
+    int slot;                // Which player's input drives this submarine
+} Player;
+
+// Anything hostile to the player: contact deals damage and removes the entity
+typedef struct Enemy {
+    int contactDamage;
+    int scoreValue;
+} Enemy;
+
+// Chases the player along the shared flow field while keeping clear of other enemies
+typedef struct Steering {
+    float maxSpeed;          // Pixels per frame
+    float maxForce;          // Largest velocity change per frame
+} Steering;
+
+// All entities with exactly the same component set, stored as one packed column per component
+typedef struct Archetype {
+    ComponentMask mask;
+    int count;
+    int capacity;
+    Entity *entities;
+    void *columns[COMPONENT_COUNT];
+} Archetype;
+
+typedef struct EntitySlot {
+    int archetype;           // -1 when the slot is free
+    int row;                 // Row in the archetype, or the next free slot while free
+    unsigned int generation;
+} EntitySlot;
+
+typedef struct World {
+    Archetype archetypes[ECS_MAX_ARCHETYPES];
+    int archetypeCount;
+    EntitySlot *slots;       // Heap array of capacity slots
+    int capacity;
+    int freeHead;            // First free slot, -1 when full
+    int entityCount;
+    int refusedSpawns;       // Spawns turned away because the table or the archetype was full
+} World;
+
+// Capacity is set at load and only changes through GrowWorld; archetype
+// storage only through ReserveEntities. Spawning and despawning never touch
+// the allocator: a spawn past either is refused and counted, the way a full
+// arena refuses.
+World *LoadWorld(int capacity);
+void UnloadWorld(World *world);
+// Adds free slots up to capacity; live handles stay valid. Call between ticks.
+bool GrowWorld(World *world, int capacity);
+// Despawns every live entity; cost follows the live count, not the capacity
+void ClearWorld(World *world);
+void ReserveEntities(World *world, ComponentMask mask, int count);
+// Appends the entity table and every live row to snapshot
+bool SaveWorld(const World *world, Snapshot *snapshot);
+// Reads back a SaveWorld block. Handles saved earlier stay valid. A snapshot
+// from a smaller world leaves the extra slots free, one from a larger world
+// grows this one; fails if the archetype order differs.
+bool RestoreWorld(World *world, Snapshot *snapshot);
+
+// New entities start with every component zeroed; ECS_INVALID_ENTITY when full
+Entity SpawnEntity(World *world, ComponentMask mask);
+// Moves the last row of the archetype into the hole, so systems that
+// despawn while iterating walk their rows backwards
+void DespawnEntity(World *world, Entity entity);
+bool IsEntityAlive(const World *world, Entity entity);
+bool HasComponent(const World *world, Entity entity, ComponentType type);
+void *GetComponent(World *world, Entity entity, ComponentType type);
+
+// Fills out with every archetype that has all of include and none of exclude
+int QueryArchetypes(World *world, ComponentMask include, ComponentMask exclude, Archetype **out, int maxOut);
+int CountEntities(World *world, ComponentMask include, ComponentMask exclude);
+void DespawnMatching(World *world, ComponentMask include, ComponentMask exclude);
+
+#endif
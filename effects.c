@@ -0,0 +1,43 @@
+#include "effects.h"
+
+#define HIT_RADIUS 48.0f
+#define KILL_RADIUS 40.0f
+#define BOSS_KILL_RADIUS 160.0f
+
+static void AddEffect(EffectList *list, Vector2 position, float radius, Color color) {
+    if (list->count == EFFECT_CAPACITY) return;
+    list->effects[list->count++] = (Effect){ position, 0.0f, radius, color };
+}
+
+void AddEventEffects(EffectList *list, const EventQueue *events) {
+    for (int i = 0; i < events->count; i++) {
+        const GameEvent *event = &events->events[i];
+        if (event->type == EVENT_HIT) {
+            AddEffect(list, event->position, HIT_RADIUS, RED);
+        } else if (event->type == EVENT_KILL) {
+            AddEffect(list, event->position, (event->flags & EVENT_FLAG_BOSS) ? BOSS_KILL_RADIUS : KILL_RADIUS, ORANGE);
+        }
+    }
+}
+
+void UpdateEffects(EffectList *list, float deltaTime) {
+    // Order does not matter, so finished effects are swapped out
+    for (int i = list->count - 1; i >= 0; i--) {
+        list->effects[i].age += deltaTime;
+        if (list->effects[i].age >= EFFECT_DURATION) {
+            list->effects[i] = list->effects[--list->count];
+        }
+    }
+}
+
+void DrawEffects(const EffectList *list) {
+    for (int i = 0; i < list->count; i++) {
+        const Effect *effect = &list->effects[i];
+        float t = effect->age / EFFECT_DURATION;
+        DrawCircleV(effect->position, effect->radius * (0.3f + 0.7f * t), Fade(effect->color, 0.6f * (1.0f - t)));
+    }
+}
+
+void ClearEffects(EffectList *list) {
+    list->count = 0;
+}
@@ -0,0 +1,33 @@
+#ifndef EFFECTS_H
+#define EFFECTS_H
+
+#include "raylib.h"
+#include "events.h"
+
+#define EFFECT_CAPACITY 64
+#define EFFECT_DURATION 0.4f             // Seconds an effect takes to grow and fade
+
+// One burst that grows and fades where something happened
+typedef struct Effect {
+    Vector2 position;
+    float age;
+    float radius;                        // Size it grows to
+    Color color;
+} Effect;
+
+// What the player sees of the simulation's events: a red burst on a submarine
+// that was hit and an orange one where an enemy was destroyed. Presentation
+// only; a full list ignores new effects instead of growing.
+typedef struct EffectList {
+    Effect effects[EFFECT_CAPACITY];
+    int count;
+} EffectList;
+
+// Raises the effects for one tick's events. Called once per tick, the first
+// time it runs; a rollback's resimulated ticks were already shown.
+void AddEventEffects(EffectList *list, const EventQueue *events);
+void UpdateEffects(EffectList *list, float deltaTime);
+void DrawEffects(const EffectList *list);
+void ClearEffects(EffectList *list);
+
+#endif
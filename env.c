@@ -0,0 +1,326 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "env.h"
+#include "simulation.h"
+#include "snapshot.h"
+#include "pattern.h"
+#include "workers.h"
+
+// Build step: the game's simulation as a shared library, no window opened
+// gcc -shared -O2 -DENV_BUILD env.c simulation.c config.c workers.c ecs.c systems.c bullets.c pattern.c collision.c flowfield.c rng.c snapshot.c drawlist.c arena.c director.c bitmask.c tilemap.c events.c buffs.c -o submarine_env.dll -I -L -lraylib -lopengl32 -lgdi32 -lwinmm
+
+#define OBS_GAME 8               // Submarine and run
+#define OBS_OBJECT 5             // Per enemy or bullet: present, offset, velocity
+#define OBS_SIZE (OBS_GAME + (ENV_OBS_ENEMIES + ENV_OBS_BULLETS) * OBS_OBJECT)
+
+#define REWARD_PER_SCORE 0.01f
+#define REWARD_PER_DAMAGE 0.01f
+#define ENV_SCRATCH_SIZE (64 * 1024)
+
+// One game: its own world, bullets and flow field, so games share nothing while stepping
+typedef struct EnvGame {
+    World *world;
+    BulletField bullets;
+    FlowField *flow;
+    EventQueue events;
+    Arena scratch;               // Per-tick collision lists, rewound by every step
+    RunState run;
+    Snapshot start;              // Freshly loaded game, restored by every reset
+    Rng seeds;                   // Seeds this game's episodes
+    int ticks;
+} EnvGame;
+
+// Candidates for the nearest-object slots of an observation
+typedef struct Nearby {
+    float distance;
+    float values[OBS_OBJECT - 1];
+} Nearby;
+
+struct Env {
+    GameConfig config;
+    SpriteMasks masks;           // Shared, read-only once built
+    int count;
+    int difficulty;
+    EnvGame *games;
+    WorkerPool *workers;
+    const int *actions;          // Valid during env_step
+    float *observations;
+    float *rewards;
+    unsigned char *dones;
+};
+
+static PlayerInput GetActionInput(int action) {
+    PlayerInput input = { 0 };
+    input.moveX = (signed char)(((action & ENV_ACTION_RIGHT) != 0) - ((action & ENV_ACTION_LEFT) != 0));
+    input.moveY = (signed char)(((action & ENV_ACTION_DOWN) != 0) - ((action & ENV_ACTION_UP) != 0));
+    if (action & ENV_ACTION_BOOST) input.buttons |= INPUT_BOOST;
+    if (action & ENV_ACTION_FIRE) input.buttons |= INPUT_FIRE;
+    if (action & ENV_ACTION_SPECIAL) input.buttons |= INPUT_SPECIAL;
+    return input;
+}
+
+// Keeps the slotCount nearest candidates, sorted, in an insertion pass
+static void KeepNearest(Nearby *slots, int *used, int slotCount, Nearby candidate) {
+    int i = *used;
+    if (i == slotCount) {
+        if (candidate.distance >= slots[slotCount - 1].distance) return;
+        i--;
+    } else {
+        (*used)++;
+    }
+    while (i > 0 && slots[i - 1].distance > candidate.distance) {
+        slots[i] = slots[i - 1];
+        i--;
+    }
+    slots[i] = candidate;
+}
+
+static float *WriteNearby(float *out, const Nearby *slots, int used, int slotCount) {
+    for (int i = 0; i < slotCount; i++, out += OBS_OBJECT) {
+        if (i >= used) {
+            memset(out, 0, OBS_OBJECT * sizeof(float));
+            continue;
+        }
+        out[0] = 1.0f;
+        memcpy(out + 1, slots[i].values, sizeof(slots[i].values));
+    }
+    return out;
+}
+
+// Positions are fractions of the playfield, offsets and velocities relative to the submarine
+static void WriteObservation(const Env *env, EnvGame *game, float *out) {
+    const GameConfig *config = &env->config;
+    World *world = game->world;
+    Entity player = game->run.players[0];
+    const Rectangle rect = ((Transform *)GetComponent(world, player, COMPONENT_TRANSFORM))->rect;
+    const Health *health = GetComponent(world, player, COMPONENT_HEALTH);
+    const Player *state = GetComponent(world, player, COMPONENT_PLAYER);
+    Vector2 center = { rect.x + rect.width / 2, rect.y + rect.height / 2 };
+    float width = (float)config->screenWidth;
+    float height = (float)config->screenHeight;
+
+    out[0] = center.x / width;
+    out[1] = center.y / height;
+    out[2] = (float)health->current / health->max;
+    out[3] = state->energy / 100.0f;
+    out[4] = state->specialTimer <= 0.0f ? 1.0f : 0.0f;
+    out[5] = (float)game->run.wave / config->maxWaves;
+    out[6] = (float)CountEntities(world, HAS_HEALTH | HAS_ENEMY, 0) / config->maxEnemies;
+    out[7] = (float)game->ticks / ENV_MAX_TICKS;
+    out += OBS_GAME;
+
+    Nearby enemies[ENV_OBS_ENEMIES];
+    int enemyCount = 0;
+    Archetype *matches[ECS_MAX_ARCHETYPES];
+    int matchCount = QueryArchetypes(world, HAS_TRANSFORM | HAS_VELOCITY | HAS_HEALTH | HAS_ENEMY, 0, matches, ECS_MAX_ARCHETYPES);
+    for (int m = 0; m < matchCount; m++) {
+        Transform *transforms = matches[m]->columns[COMPONENT_TRANSFORM];
+        Velocity *velocities = matches[m]->columns[COMPONENT_VELOCITY];
+        for (int i = 0; i < matches[m]->count; i++) {
+            float dx = transforms[i].rect.x + transforms[i].rect.width / 2 - center.x;
+            float dy = transforms[i].rect.y + transforms[i].rect.height / 2 - center.y;
+            KeepNearest(enemies, &enemyCount, ENV_OBS_ENEMIES, (Nearby){
+                dx * dx + dy * dy, { dx / width, dy / height, velocities[i].value.x / 10.0f, velocities[i].value.y / 10.0f }
+            });
+        }
+    }
+    out = WriteNearby(out, enemies, enemyCount, ENV_OBS_ENEMIES);
+
+    Nearby bullets[ENV_OBS_BULLETS];
+    int bulletCount = 0;
+    const BulletField *field = &game->bullets;
+    for (int i = 0; i < field->count; i++) {
+        float dx = field->x[i] + field->width[i] / 2 - center.x;
+        float dy = field->y[i] + field->height[i] / 2 - center.y;
+        KeepNearest(bullets, &bulletCount, ENV_OBS_BULLETS, (Nearby){
+            dx * dx + dy * dy, { dx / width, dy / height, field->vx[i] / 10.0f, field->vy[i] / 10.0f }
+        });
+    }
+    WriteNearby(out, bullets, bulletCount, ENV_OBS_BULLETS);
+}
+
+// Back to the loaded game, then the first wave from a fresh seed
+static void RestartGame(const Env *env, EnvGame *game) {
+    RewindSnapshot(&game->start);
+    ReadSnapshot(&game->start, &game->run, sizeof(RunState));
+    RestoreWorld(game->world, &game->start);
+    RestoreBulletField(&game->bullets, &game->start);
+
+    game->run.difficultyLevel = env->difficulty;
+    game->run.rng = SeedRng(NextRng(&game->seeds));
+    game->ticks = 0;
+    SpawnWave(game->world, &game->run.rng, game->run.wave, game->run.maxEnemies, game->run.difficultyLevel, &env->config);
+}
+
+// Hits match the game's when the images are next to the library; without them
+// every mask is empty and collisions fall back to rectangles
+static void LoadEnvMasks(Env *env) {
+    static const char *enemyImageNames[ENEMY_FRAMES * 2] = {
+        "images/normalEnemy_front.png", "images/normalEnemy2_front.png", "images/normalEnemy3_front.png",
+        "images/normalEnemy_back.png", "images/normalEnemy2_back.png", "images/normalEnemy3_back.png"
+    };
+    Image submarine = LoadImage("images/submarine.png");
+    Image enemy[ENEMY_FRAMES * 2];
+    for (int i = 0; i < ENEMY_FRAMES * 2; i++) enemy[i] = LoadImage(enemyImageNames[i]);
+    env->masks = LoadSpriteMasks(submarine, enemy, &env->config);
+    UnloadImage(submarine);
+    for (int i = 0; i < ENEMY_FRAMES * 2; i++) UnloadImage(enemy[i]);
+}
+
+static void StepGame(void *context, int index) {
+    Env *env = context;
+    EnvGame *game = &env->games[index];
+    RunState *run = &game->run;
+    const Health *health = GetComponent(game->world, run->players[0], COMPONENT_HEALTH);
+    int healthBefore = health->current;
+    int scoreBefore = run->score;
+
+    PlayerInput inputs[MAX_PLAYERS] = { GetActionInput(env->actions[index]) };
+    StepRun(run, game->world, &game->bullets, game->flow, &env->masks, NULL, &game->events, &game->scratch, &env->config, inputs);
+    game->ticks++;
+
+    // The buff screens after waves 2 and 4 are skipped; the next wave follows straight away
+    bool alive = health->current > 0;
+    if (alive && !run->bossDefeated && (run->wave == 2 || run->wave == 4) &&
+        CountEntities(game->world, HAS_HEALTH | HAS_ENEMY, 0) == 0) {
+        run->wave++;
+        run->maxEnemies = run->wave * 5;
+        SpawnWave(game->world, &run->rng, run->wave, run->maxEnemies, run->difficultyLevel, &env->config);
+    }
+
+    env->rewards[index] = (run->score - scoreBefore) * REWARD_PER_SCORE - (healthBefore - health->current) * REWARD_PER_DAMAGE;
+    unsigned char done = 0;
+    if (!alive || run->bossDefeated) done |= ENV_DONE_TERMINAL;
+    if (game->ticks >= ENV_MAX_TICKS) done |= ENV_DONE_TRUNCATED;
+    env->dones[index] = done;
+
+    if (done) RestartGame(env, game);
+    WriteObservation(env, game, &env->observations[index * OBS_SIZE]);
+}
+
+static void ResetGame(void *context, int index) {
+    Env *env = context;
+    EnvGame *game = &env->games[index];
+    RestartGame(env, game);
+    env->rewards[index] = 0.0f;
+    env->dones[index] = 0;
+    WriteObservation(env, game, &env->observations[index * OBS_SIZE]);
+}
+
+static bool LoadEnvGame(const GameConfig *config, EnvGame *game) {
+    game->world = LoadWorld(GetWorldCapacity(config));
+    game->bullets = LoadBulletField(config->maxBossBullets);
+    game->flow = LoadFlowField(config->screenWidth, config->screenHeight, 40.0f);
+    game->start = LoadSnapshot(4096);
+    game->scratch = LoadArena(ENV_SCRATCH_SIZE);
+    if (game->world == NULL || game->bullets.x == NULL || game->flow == NULL || game->scratch.base == NULL) return false;
+    game->events = LoadEventQueue(GetRunEventCapacity(game->world));
+    if (game->events.events == NULL || !ReserveFlowPoints(game->flow, GetEnemyCeiling(config))) return false;
+
+    ReserveWorld(game->world, config);
+    game->run = (RunState){ .wave = 1, .maxEnemies = 5, .difficultyLevel = 1, .playerCount = 1 };
+    game->run.players[0] = SpawnPlayer(game->world, config, 0);
+    game->run.stats = ResolveRunStats(game->run.buffStacks, config);
+    game->seeds = SeedRng(0);
+    ClearSnapshot(&game->start);
+    return WriteSnapshot(&game->start, &game->run, sizeof(RunState)) &&
+           SaveWorld(game->world, &game->start) &&
+           SaveBulletField(&game->bullets, &game->start);
+}
+
+static void UnloadEnvGame(EnvGame *game) {
+    UnloadWorld(game->world);
+    UnloadBulletField(game->bullets);
+    UnloadFlowField(game->flow);
+    UnloadArena(game->scratch);
+    UnloadEventQueue(game->events);
+    UnloadSnapshot(game->start);
+}
+
+Env *env_create(int count) {
+    if (count < 1) return NULL;
+    Env *env = calloc(1, sizeof(Env));
+    if (env == NULL) return NULL;
+
+    // Bots play the same tuning as the game when its file is present
+    env->config = DefaultGameConfig();
+    LoadGameConfig("tuning.txt", &env->config);
+    env->count = count;
+    env->difficulty = 1;
+    env->games = calloc(count, sizeof(EnvGame));
+    env->observations = calloc((size_t)count * OBS_SIZE, sizeof(float));
+    env->rewards = calloc(count, sizeof(float));
+    env->dones = calloc(count, sizeof(unsigned char));
+    if (env->games == NULL || env->observations == NULL || env->rewards == NULL || env->dones == NULL) {
+        env_destroy(env);
+        return NULL;
+    }
+
+    // Shared tables are built before any thread can race to build them
+    InitPatterns();
+    LoadEnvMasks(env);
+    for (int i = 0; i < count; i++) {
+        if (!LoadEnvGame(&env->config, &env->games[i])) {
+            env_destroy(env);
+            return NULL;
+        }
+    }
+
+    int threads = GetProcessorCount();
+    env->workers = LoadWorkerPool(threads < count ? threads : count);
+    if (env->workers == NULL) {
+        env_destroy(env);
+        return NULL;
+    }
+    env_reset(env, 1, 1);
+    return env;
+}
+
+void env_destroy(Env *env) {
+    if (env == NULL) return;
+    UnloadWorkerPool(env->workers);
+    if (env->games != NULL) {
+        for (int i = 0; i < env->count; i++) UnloadEnvGame(&env->games[i]);
+    }
+    free(env->games);
+    UnloadSpriteMasks(env->masks);
+    free(env->observations);
+    free(env->rewards);
+    free(env->dones);
+    free(env);
+}
+
+void env_reset(Env *env, unsigned int seed, int difficulty) {
+    env->difficulty = (difficulty < 1) ? 1 : (difficulty > 3) ? 3 : difficulty;
+    for (int i = 0; i < env->count; i++) {
+        env->games[i].seeds = SeedRng(seed ^ ((unsigned int)i * 0x9E3779B9u));
+    }
+    RunWorkers(env->workers, ResetGame, env, env->count);
+}
+
+void env_step(Env *env, const int *actions) {
+    env->actions = actions;
+    RunWorkers(env->workers, StepGame, env, env->count);
+    env->actions = NULL;
+}
+
+int env_count(const Env *env) {
+    return env->count;
+}
+
+int env_observation_size(void) {
+    return OBS_SIZE;
+}
+
+const float *env_observations(const Env *env) {
+    return env->observations;
+}
+
+const float *env_rewards(const Env *env) {
+    return env->rewards;
+}
+
+const unsigned char *env_dones(const Env *env) {
+    return env->dones;
+}
@@ -0,0 +1,52 @@
+#ifndef ENV_H
+#define ENV_H
+
+// Headless batch of independent games for training and soak-testing bots.
+// No window, no GPU and no input devices: actions come in as bits, and
+// observations, rewards and done flags go out through flat buffers the
+// caller can wrap without copying (numpy, for one). Names follow the usual
+// C training-API convention rather than the game's, for foreign callers.
+
+#if defined(_WIN32) && defined(ENV_BUILD)
+#define ENV_API __declspec(dllexport)
+#else
+#define ENV_API
+#endif
+
+// Action bits, one int per game per step
+#define ENV_ACTION_UP 0x01
+#define ENV_ACTION_DOWN 0x02
+#define ENV_ACTION_LEFT 0x04
+#define ENV_ACTION_RIGHT 0x08
+#define ENV_ACTION_BOOST 0x10
+#define ENV_ACTION_FIRE 0x20
+#define ENV_ACTION_SPECIAL 0x40
+
+// Done flags; a finished game restarts inside the same step
+#define ENV_DONE_TERMINAL 0x01   // The submarine sank or the boss fell
+#define ENV_DONE_TRUNCATED 0x02  // Ran into the tick limit
+
+#define ENV_OBS_ENEMIES 8        // Nearest enemies observed
+#define ENV_OBS_BULLETS 16       // Nearest enemy bullets observed
+#define ENV_MAX_TICKS (60 * 60 * 5)
+
+typedef struct Env Env;
+
+// count games stepped across one thread per processor
+ENV_API Env *env_create(int count);
+ENV_API void env_destroy(Env *env);
+// Restarts every game at difficulty 1 to 3. Game i's episodes are seeded from
+// seed and i alone, so results do not depend on the thread count.
+ENV_API void env_reset(Env *env, unsigned int seed, int difficulty);
+// Advances every game one tick with actions[i]; games that finish are restarted
+// and report the first observation of their next episode
+ENV_API void env_step(Env *env, const int *actions);
+
+ENV_API int env_count(const Env *env);
+ENV_API int env_observation_size(void);
+// count * env_observation_size() floats, game-major
+ENV_API const float *env_observations(const Env *env);
+ENV_API const float *env_rewards(const Env *env);
+ENV_API const unsigned char *env_dones(const Env *env);
+
+#endif
@@ -0,0 +1,35 @@
+#include "events.h"
+#include <stdlib.h>
+
+EventQueue LoadEventQueue(int capacity) {
+    EventQueue queue = { 0 };
+    ReserveEventQueue(&queue, capacity);
+    return queue;
+}
+
+void UnloadEventQueue(EventQueue queue) {
+    free(queue.events);
+}
+
+bool ReserveEventQueue(EventQueue *queue, int capacity) {
+    if (capacity <= queue->capacity) return true;
+    GameEvent *events = realloc(queue->events, capacity * sizeof(GameEvent));
+    if (events == NULL) return false;
+    queue->events = events;
+    queue->capacity = capacity;
+    return true;
+}
+
+void ClearEventQueue(EventQueue *queue) {
+    queue->count = 0;
+    queue->dropped = 0;
+}
+
+bool PushEvent(EventQueue *queue, GameEvent event) {
+    if (queue->count == queue->capacity) {
+        queue->dropped++;
+        return false;
+    }
+    queue->events[queue->count++] = event;
+    return true;
+}
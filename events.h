@@ -0,0 +1,47 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include "raylib.h"
+
+#define EVENT_FLAG_BOSS 0x1
+
+typedef enum GameEventType {
+    EVENT_KILL,                  // value: score; slot: the submarine whose shot it was; position: the enemy's centre
+    EVENT_HIT                    // value: damage; slot: the submarine hit; position: its centre
+} GameEventType;
+
+typedef struct GameEvent {
+    unsigned char type;          // GameEventType
+    unsigned char slot;
+    unsigned char flags;
+    short value;
+    Vector2 position;
+} GameEvent;
+
+// What collision found during one tick. Collision only appends; the reactions
+// (score, energy, buffs, victory) read the whole queue once it is done, so a
+// new reaction needs no change to the collision loops.
+//
+// The queue is cleared at the start of every tick, so it only ever holds the
+// tick that ran last. Presentation (hit and kill effects) reads it right after
+// each tick, and only the first time that tick runs: ticks a rollback
+// resimulates were already shown and would show twice.
+// Whoever loads the world reserves room for every event its entities can raise
+// in a tick, and again whenever the world grows, so kills are never lost to a
+// full queue; the tick itself never allocates.
+typedef struct EventQueue {
+    int count;
+    int capacity;
+    int dropped;                 // Events that did not fit this tick; only if a reservation failed
+    GameEvent *events;
+} EventQueue;
+
+EventQueue LoadEventQueue(int capacity);
+void UnloadEventQueue(EventQueue queue);
+// Grows the queue to hold at least capacity events; false, keeping the old size,
+// when out of memory. Call between ticks.
+bool ReserveEventQueue(EventQueue *queue, int capacity);
+void ClearEventQueue(EventQueue *queue);
+bool PushEvent(EventQueue *queue, GameEvent event);
+
+#endif
@@ -0,0 +1,182 @@
+#include "flowfield.h"
+#include <stdlib.h>
+#include <math.h>
+
+#define FLOW_UNREACHED 0xFFFF
+
+static const int neighbourX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+static const int neighbourY[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+
+static Vector2 Normalize(Vector2 v) {
+    float length = sqrtf(v.x * v.x + v.y * v.y);
+    if (length < 0.0001f) return (Vector2){ 0, 0 };
+    return (Vector2){ v.x / length, v.y / length };
+}
+
+static Vector2 CellCenter(const FlowField *field, int x, int y) {
+    return (Vector2){ (x + 0.5f) * field->cellSize, (y + 0.5f) * field->cellSize };
+}
+
+FlowField *LoadFlowField(int width, int height, float cellSize) {
+    FlowField *field = calloc(1, sizeof(FlowField));
+    if (field == NULL) return NULL;
+
+    field->cellSize = cellSize;
+    field->columns = (int)ceilf(width / cellSize);
+    field->rows = (int)ceilf(height / cellSize);
+
+    // Coarsen the grid rather than overflow it on very large playfields
+    while (field->columns * field->rows > FLOW_MAX_CELLS) {
+        field->cellSize *= 2;
+        field->columns = (int)ceilf(width / field->cellSize);
+        field->rows = (int)ceilf(height / field->cellSize);
+    }
+    return field;
+}
+
+void UnloadFlowField(FlowField *field) {
+    if (field == NULL) return;
+    free(field->points);
+    free(field->pointCells);
+    free(field->sortedPoints);
+    free(field);
+}
+
+int GetFlowCell(const FlowField *field, Vector2 position) {
+    int x = (int)(position.x / field->cellSize);
+    int y = (int)(position.y / field->cellSize);
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x >= field->columns) x = field->columns - 1;
+    if (y >= field->rows) y = field->rows - 1;
+    return y * field->columns + x;
+}
+
+void UpdateFlowField(FlowField *field, const Vector2 *targets, int targetCount) {
+    int cellCount = field->columns * field->rows;
+    int queue[FLOW_MAX_CELLS];
+    int head = 0;
+    int tail = 0;
+
+    if (targetCount > FLOW_MAX_TARGETS) targetCount = FLOW_MAX_TARGETS;
+    field->targetCount = targetCount;
+    for (int t = 0; t < targetCount; t++) {
+        field->targets[t] = targets[t];
+    }
+    for (int i = 0; i < cellCount; i++) {
+        field->cost[i] = FLOW_UNREACHED;
+    }
+
+    // Breadth-first integration from every target at once; each cell keeps the first to reach it
+    for (int t = 0; t < targetCount; t++) {
+        int start = GetFlowCell(field, targets[t]);
+        if (field->cost[start] == 0) continue;
+        field->cost[start] = 0;
+        field->owner[start] = (unsigned char)t;
+        queue[tail++] = start;
+    }
+
+    while (head < tail) {
+        int cell = queue[head++];
+        int x = cell % field->columns;
+        int y = cell / field->columns;
+
+        for (int n = 0; n < 8; n++) {
+            int nx = x + neighbourX[n];
+            int ny = y + neighbourY[n];
+            if (nx < 0 || ny < 0 || nx >= field->columns || ny >= field->rows) continue;
+
+            int next = ny * field->columns + nx;
+            if (field->cost[next] != FLOW_UNREACHED) continue;
+            field->cost[next] = field->cost[cell] + 1;
+            field->owner[next] = field->owner[cell];
+            queue[tail++] = next;
+        }
+    }
+
+    // Each cell points at its cheapest neighbour; ties go to the one nearest the target
+    for (int cell = 0; cell < cellCount; cell++) {
+        int x = cell % field->columns;
+        int y = cell / field->columns;
+        Vector2 center = CellCenter(field, x, y);
+        Vector2 target = field->targets[field->owner[cell]];
+
+        if (field->cost[cell] == 0) {
+            field->direction[cell] = Normalize((Vector2){ target.x - center.x, target.y - center.y });
+            continue;
+        }
+        if (field->cost[cell] == FLOW_UNREACHED) {
+            field->direction[cell] = (Vector2){ 0, 0 };
+            continue;
+        }
+
+        int bestCost = field->cost[cell];
+        float bestDistance = 0.0f;
+        Vector2 best = { 0, 0 };
+        for (int n = 0; n < 8; n++) {
+            int nx = x + neighbourX[n];
+            int ny = y + neighbourY[n];
+            if (nx < 0 || ny < 0 || nx >= field->columns || ny >= field->rows) continue;
+
+            int next = ny * field->columns + nx;
+            Vector2 nextCenter = CellCenter(field, nx, ny);
+            float dx = target.x - nextCenter.x;
+            float dy = target.y - nextCenter.y;
+            float distance = dx * dx + dy * dy;
+
+            if (field->cost[next] < bestCost || (field->cost[next] == bestCost && bestCost < field->cost[cell] && distance < bestDistance)) {
+                bestCost = field->cost[next];
+                bestDistance = distance;
+                best = (Vector2){ (float)neighbourX[n], (float)neighbourY[n] };
+            }
+        }
+        field->direction[cell] = Normalize(best);
+    }
+}
+
+Vector2 SampleFlowField(const FlowField *field, Vector2 position) {
+    return field->direction[GetFlowCell(field, position)];
+}
+
+bool ReserveFlowPoints(FlowField *field, int capacity) {
+    if (capacity <= field->pointCapacity) return true;
+
+    Vector2 *points = realloc(field->points, capacity * sizeof(Vector2));
+    if (points != NULL) field->points = points;
+    int *cells = realloc(field->pointCells, capacity * sizeof(int));
+    if (cells != NULL) field->pointCells = cells;
+    Vector2 *sorted = realloc(field->sortedPoints, capacity * sizeof(Vector2));
+    if (sorted != NULL) field->sortedPoints = sorted;
+    if (points == NULL || cells == NULL || sorted == NULL) return false;
+
+    field->pointCapacity = capacity;
+    return true;
+}
+
+void BeginFlowPoints(FlowField *field) {
+    field->pointCount = 0;
+}
+
+void AddFlowPoint(FlowField *field, Vector2 point) {
+    if (field->pointCount == field->pointCapacity) {
+        field->refusedPoints++;
+        return;
+    }
+
+    int i = field->pointCount++;
+    field->points[i] = point;
+    field->pointCells[i] = GetFlowCell(field, point);
+}
+
+void SortFlowPoints(FlowField *field) {
+    int cellCount = field->columns * field->rows;
+
+    for (int c = 0; c <= cellCount; c++) field->cellStart[c] = 0;
+    for (int i = 0; i < field->pointCount; i++) field->cellStart[field->pointCells[i] + 1]++;
+    for (int c = 0; c < cellCount; c++) field->cellStart[c + 1] += field->cellStart[c];
+
+    for (int c = 0; c < cellCount; c++) field->cellFill[c] = field->cellStart[c];
+    for (int i = 0; i < field->pointCount; i++) {
+        field->sortedPoints[field->cellFill[field->pointCells[i]]++] = field->points[i];
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+#include "raylib.h"
+
+#define FLOW_MAX_CELLS 4096
+#define FLOW_MAX_TARGETS 4
+
+// Coarse grid over the playfield holding, for every cell, the direction of the
+// shortest path to the nearest of a few targets. Rebuilt once per tick; any number of agents
+// then steer by looking up the cell they are in.
+typedef struct FlowField {
+    int columns;
+    int rows;
+    float cellSize;
+    Vector2 targets[FLOW_MAX_TARGETS];
+    int targetCount;
+    unsigned short cost[FLOW_MAX_CELLS];     // Steps to the nearest target's cell
+    unsigned char owner[FLOW_MAX_CELLS];     // Which target that is
+    Vector2 direction[FLOW_MAX_CELLS];       // Unit vector towards the next cell on the path
+
+    // Agent positions bucketed by cell, for neighbour queries
+    int pointCount;
+    int pointCapacity;
+    int refusedPoints;                       // Points dropped because the buffers were full
+    Vector2 *points;                         // In insertion order
+    int *pointCells;
+    Vector2 *sortedPoints;                   // Grouped by cell
+    int cellStart[FLOW_MAX_CELLS + 1];       // Cell c owns sortedPoints[cellStart[c]..cellStart[c + 1])
+    int cellFill[FLOW_MAX_CELLS];
+} FlowField;
+
+FlowField *LoadFlowField(int width, int height, float cellSize);
+void UnloadFlowField(FlowField *field);
+// Agents anywhere head for whichever target is fewest steps away
+void UpdateFlowField(FlowField *field, const Vector2 *targets, int targetCount);
+// Index of the cell containing position, clamped to the grid
+int GetFlowCell(const FlowField *field, Vector2 position);
+Vector2 SampleFlowField(const FlowField *field, Vector2 position);
+// Sizes the point buckets for capacity agents; call at load or retune, never from a tick
+bool ReserveFlowPoints(FlowField *field, int capacity);
+// Empties the point buckets. Points past the reservation are dropped and counted.
+void BeginFlowPoints(FlowField *field);
+void AddFlowPoint(FlowField *field, Vector2 point);
+// Groups the added points by cell into sortedPoints (counting sort)
+void SortFlowPoints(FlowField *field);
+
+#endif
@@ -0,0 +1,255 @@
+#include "input.h"
+#include <stdio.h>
+
+#define STICK_DEADZONE 0.35f
+#define INPUT_EDGES (INPUT_FIRE | INPUT_SPECIAL)
+#define CAPTURE_AXIS_THRESHOLD 0.6f
+#define GAMEPAD_BUTTON_COUNT 18
+#define GAMEPAD_AXIS_COUNT 6
+#define MAX_KEY_CODE 511             // raylib tracks keyboard keys below 512
+
+static const char *actionNames[ACTION_COUNT] = {
+    [ACTION_MOVE_UP] = "Move Up",
+    [ACTION_MOVE_DOWN] = "Move Down",
+    [ACTION_MOVE_LEFT] = "Move Left",
+    [ACTION_MOVE_RIGHT] = "Move Right",
+    [ACTION_BOOST] = "Speed Boost",
+    [ACTION_FIRE] = "Shoot",
+    [ACTION_SPECIAL] = "Special Attack",
+    [ACTION_PAUSE] = "Pause",
+};
+
+static const char *gamepadButtonNames[GAMEPAD_BUTTON_COUNT] = {
+    "Pad ?", "D-Pad Up", "D-Pad Right", "D-Pad Down", "D-Pad Left",
+    "Pad Y", "Pad B", "Pad A", "Pad X",
+    "Pad LB", "Pad LT", "Pad RB", "Pad RT",
+    "Pad Back", "Pad Guide", "Pad Start", "Pad L3", "Pad R3"
+};
+
+static const char *gamepadAxisNames[GAMEPAD_AXIS_COUNT] = {
+    "Left Stick X", "Left Stick Y", "Right Stick X", "Right Stick Y", "Pad LT", "Pad RT"
+};
+
+static void Bind(InputMap *map, InputAction action, int slot, BindingType type, int code, int direction) {
+    map->bindings[action][slot] = (Binding){ (unsigned char)type, (signed char)direction, (short)code };
+}
+
+static bool IsBindingDown(const InputMap *map, Binding binding) {
+    switch (binding.type) {
+        case BINDING_KEY:
+            return IsKeyDown(binding.code);
+        case BINDING_MOUSE_BUTTON:
+            return IsMouseButtonDown(binding.code);
+        case BINDING_GAMEPAD_BUTTON:
+            return IsGamepadAvailable(map->gamepad) && IsGamepadButtonDown(map->gamepad, binding.code);
+        case BINDING_GAMEPAD_AXIS:
+            return IsGamepadAvailable(map->gamepad) &&
+                   GetGamepadAxisMovement(map->gamepad, binding.code) * binding.direction > map->deadzone;
+        default:
+            return false;
+    }
+}
+
+InputMap DefaultKeyboardMap(void) {
+    InputMap map = { .gamepad = -1, .deadzone = STICK_DEADZONE };
+    Bind(&map, ACTION_MOVE_UP, 0, BINDING_KEY, KEY_W, 0);
+    Bind(&map, ACTION_MOVE_DOWN, 0, BINDING_KEY, KEY_S, 0);
+    Bind(&map, ACTION_MOVE_LEFT, 0, BINDING_KEY, KEY_A, 0);
+    Bind(&map, ACTION_MOVE_RIGHT, 0, BINDING_KEY, KEY_D, 0);
+    Bind(&map, ACTION_BOOST, 0, BINDING_KEY, KEY_LEFT_SHIFT, 0);
+    Bind(&map, ACTION_FIRE, 0, BINDING_MOUSE_BUTTON, MOUSE_BUTTON_LEFT, 0);
+    Bind(&map, ACTION_SPECIAL, 0, BINDING_MOUSE_BUTTON, MOUSE_BUTTON_RIGHT, 0);
+    Bind(&map, ACTION_PAUSE, 0, BINDING_KEY, KEY_P, 0);
+    return map;
+}
+
+// D-pad and face buttons first, the left stick as the second binding for movement
+InputMap DefaultGamepadMap(int gamepad) {
+    InputMap map = { .gamepad = gamepad, .deadzone = STICK_DEADZONE };
+    Bind(&map, ACTION_MOVE_UP, 0, BINDING_GAMEPAD_BUTTON, GAMEPAD_BUTTON_LEFT_FACE_UP, 0);
+    Bind(&map, ACTION_MOVE_DOWN, 0, BINDING_GAMEPAD_BUTTON, GAMEPAD_BUTTON_LEFT_FACE_DOWN, 0);
+    Bind(&map, ACTION_MOVE_LEFT, 0, BINDING_GAMEPAD_BUTTON, GAMEPAD_BUTTON_LEFT_FACE_LEFT, 0);
+    Bind(&map, ACTION_MOVE_RIGHT, 0, BINDING_GAMEPAD_BUTTON, GAMEPAD_BUTTON_LEFT_FACE_RIGHT, 0);
+    Bind(&map, ACTION_MOVE_UP, 1, BINDING_GAMEPAD_AXIS, GAMEPAD_AXIS_LEFT_Y, -1);
+    Bind(&map, ACTION_MOVE_DOWN, 1, BINDING_GAMEPAD_AXIS, GAMEPAD_AXIS_LEFT_Y, 1);
+    Bind(&map, ACTION_MOVE_LEFT, 1, BINDING_GAMEPAD_AXIS, GAMEPAD_AXIS_LEFT_X, -1);
+    Bind(&map, ACTION_MOVE_RIGHT, 1, BINDING_GAMEPAD_AXIS, GAMEPAD_AXIS_LEFT_X, 1);
+    Bind(&map, ACTION_BOOST, 0, BINDING_GAMEPAD_BUTTON, GAMEPAD_BUTTON_LEFT_TRIGGER_1, 0);
+    Bind(&map, ACTION_FIRE, 0, BINDING_GAMEPAD_BUTTON, GAMEPAD_BUTTON_RIGHT_FACE_DOWN, 0);
+    Bind(&map, ACTION_SPECIAL, 0, BINDING_GAMEPAD_BUTTON, GAMEPAD_BUTTON_RIGHT_FACE_LEFT, 0);
+    Bind(&map, ACTION_PAUSE, 0, BINDING_GAMEPAD_BUTTON, GAMEPAD_BUTTON_MIDDLE_RIGHT, 0);
+    return map;
+}
+
+// Edges come from comparing with the previous update rather than from raylib's
+// per-device pressed state, so keys, buttons and stick directions all behave alike
+void UpdateInputMap(InputMap *map) {
+    unsigned int down = 0;
+    for (int a = 0; a < ACTION_COUNT; a++) {
+        for (int b = 0; b < MAX_ACTION_BINDINGS; b++) {
+            if (IsBindingDown(map, map->bindings[a][b])) {
+                down |= 1u << a;
+                break;
+            }
+        }
+    }
+    map->pressed = down & ~map->down;
+    map->down = down;
+}
+
+bool IsActionDown(const InputMap *map, InputAction action) {
+    return (map->down >> action) & 1u;
+}
+
+bool IsActionPressed(const InputMap *map, InputAction action) {
+    return (map->pressed >> action) & 1u;
+}
+
+PlayerInput GetPlayerInput(const InputMap *map) {
+    PlayerInput input = { 0 };
+    input.moveX = (signed char)(IsActionDown(map, ACTION_MOVE_RIGHT) - IsActionDown(map, ACTION_MOVE_LEFT));
+    input.moveY = (signed char)(IsActionDown(map, ACTION_MOVE_DOWN) - IsActionDown(map, ACTION_MOVE_UP));
+    if (IsActionDown(map, ACTION_BOOST)) input.buttons |= INPUT_BOOST;
+    if (IsActionPressed(map, ACTION_FIRE)) input.buttons |= INPUT_FIRE;
+    if (IsActionPressed(map, ACTION_SPECIAL)) input.buttons |= INPUT_SPECIAL;
+    return input;
+}
+
+bool CaptureBinding(const InputMap *map, bool mouse, Binding *binding) {
+    int key = GetKeyPressed();
+    if (key != 0) {
+        *binding = (Binding){ BINDING_KEY, 0, (short)key };
+        return true;
+    }
+    for (int button = MOUSE_BUTTON_LEFT; mouse && button <= MOUSE_BUTTON_MIDDLE; button++) {
+        if (IsMouseButtonPressed(button)) {
+            *binding = (Binding){ BINDING_MOUSE_BUTTON, 0, (short)button };
+            return true;
+        }
+    }
+
+    if (!IsGamepadAvailable(map->gamepad)) return false;
+    for (int button = 1; button < GAMEPAD_BUTTON_COUNT; button++) {
+        if (IsGamepadButtonPressed(map->gamepad, button)) {
+            *binding = (Binding){ BINDING_GAMEPAD_BUTTON, 0, (short)button };
+            return true;
+        }
+    }
+    // Sticks only, held well past the deadzone; triggers rest at -1 and would always match
+    for (int axis = GAMEPAD_AXIS_LEFT_X; axis <= GAMEPAD_AXIS_RIGHT_Y; axis++) {
+        float movement = GetGamepadAxisMovement(map->gamepad, axis);
+        if (movement < -CAPTURE_AXIS_THRESHOLD || movement > CAPTURE_AXIS_THRESHOLD) {
+            *binding = (Binding){ BINDING_GAMEPAD_AXIS, (signed char)(movement < 0 ? -1 : 1), (short)axis };
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *GetActionName(InputAction action) {
+    return actionNames[action];
+}
+
+const char *GetBindingName(Binding binding) {
+    switch (binding.type) {
+        case BINDING_KEY:
+            if (binding.code >= KEY_A && binding.code <= KEY_Z) return TextFormat("%c", binding.code);
+            if (binding.code >= KEY_ZERO && binding.code <= KEY_NINE) return TextFormat("%c", binding.code);
+            if (binding.code >= KEY_F1 && binding.code <= KEY_F12) return TextFormat("F%d", binding.code - KEY_F1 + 1);
+            switch (binding.code) {
+                case KEY_SPACE: return "Space";
+                case KEY_ENTER: return "Enter";
+                case KEY_TAB: return "Tab";
+                case KEY_BACKSPACE: return "Backspace";
+                case KEY_UP: return "Up";
+                case KEY_DOWN: return "Down";
+                case KEY_LEFT: return "Left";
+                case KEY_RIGHT: return "Right";
+                case KEY_LEFT_SHIFT: return "Left Shift";
+                case KEY_RIGHT_SHIFT: return "Right Shift";
+                case KEY_LEFT_CONTROL: return "Left Ctrl";
+                case KEY_RIGHT_CONTROL: return "Right Ctrl";
+                case KEY_LEFT_ALT: return "Left Alt";
+                default: return TextFormat("Key %d", binding.code);
+            }
+        case BINDING_MOUSE_BUTTON:
+            if (binding.code == MOUSE_BUTTON_LEFT) return "Left Mouse";
+            if (binding.code == MOUSE_BUTTON_RIGHT) return "Right Mouse";
+            return "Middle Mouse";
+        case BINDING_GAMEPAD_BUTTON:
+            if (binding.code < 0 || binding.code >= GAMEPAD_BUTTON_COUNT) return "Pad ?";
+            return gamepadButtonNames[binding.code];
+        case BINDING_GAMEPAD_AXIS:
+            if (binding.code < 0 || binding.code >= GAMEPAD_AXIS_COUNT) return "Pad ?";
+            return TextFormat("%s %c", gamepadAxisNames[binding.code], binding.direction < 0 ? '-' : '+');
+        default:
+            return "-";
+    }
+}
+
+bool SaveInputMaps(const char *fileName, const InputMap *maps, int count) {
+    FILE *file = fopen(fileName, "w");
+    if (file == NULL) return false;
+
+    for (int p = 0; p < count; p++) {
+        for (int a = 0; a < ACTION_COUNT; a++) {
+            fprintf(file, "%d %d", p, a);
+            for (int b = 0; b < MAX_ACTION_BINDINGS; b++) {
+                const Binding *binding = &maps[p].bindings[a][b];
+                fprintf(file, " %d %d %d", binding->type, binding->direction, binding->code);
+            }
+            fprintf(file, "\n");
+        }
+    }
+    return fclose(file) == 0;
+}
+
+// Whether a saved binding names something CaptureBinding could have produced
+static bool IsValidBinding(int type, int direction, int code) {
+    switch (type) {
+        case BINDING_NONE: return true;
+        case BINDING_KEY: return code > 0 && code <= MAX_KEY_CODE;
+        case BINDING_MOUSE_BUTTON: return code >= MOUSE_BUTTON_LEFT && code <= MOUSE_BUTTON_MIDDLE;
+        case BINDING_GAMEPAD_BUTTON: return code > 0 && code < GAMEPAD_BUTTON_COUNT;
+        case BINDING_GAMEPAD_AXIS: return code >= 0 && code < GAMEPAD_AXIS_COUNT && (direction == -1 || direction == 1);
+        default: return false;
+    }
+}
+
+// Lines that do not parse or name an unknown binding are skipped, so a missing
+// or older file keeps the defaults for whatever it does not set
+bool LoadInputMaps(const char *fileName, InputMap *maps, int count) {
+    FILE *file = fopen(fileName, "r");
+    if (file == NULL) return false;
+
+    char line[128];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        int p, a;
+        int values[MAX_ACTION_BINDINGS * 3];
+        if (sscanf(line, "%d %d %d %d %d %d %d %d", &p, &a,
+                   &values[0], &values[1], &values[2], &values[3], &values[4], &values[5]) != 8) continue;
+        if (p < 0 || p >= count || a < 0 || a >= ACTION_COUNT) continue;
+
+        bool valid = true;
+        for (int b = 0; b < MAX_ACTION_BINDINGS; b++) {
+            valid = valid && IsValidBinding(values[b * 3], values[b * 3 + 1], values[b * 3 + 2]);
+        }
+        if (!valid) continue;
+        for (int b = 0; b < MAX_ACTION_BINDINGS; b++) {
+            maps[p].bindings[a][b] = (Binding){
+                (unsigned char)values[b * 3], (signed char)values[b * 3 + 1], (short)values[b * 3 + 2]
+            };
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+PlayerInput MergeInput(PlayerInput pending, PlayerInput latest) {
+    latest.buttons |= pending.buttons & INPUT_EDGES;
+    return latest;
+}
+
+bool InputEquals(PlayerInput a, PlayerInput b) {
+    return a.moveX == b.moveX && a.moveY == b.moveY && a.buttons == b.buttons;
+}
@@ -0,0 +1,77 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "raylib.h"
+
+#define INPUT_BOOST 0x01
+#define INPUT_FIRE 0x02          // Edge: pressed since the last tick
+#define INPUT_SPECIAL 0x04       // Edge: pressed since the last tick
+
+#define MAX_ACTION_BINDINGS 2
+
+// One tick of one player's controls. Plain data, so it can be recorded,
+// sent, delayed and replayed; the simulation never polls devices itself.
+typedef struct PlayerInput {
+    signed char moveX;           // -1, 0 or 1
+    signed char moveY;
+    unsigned char buttons;       // INPUT_* bits
+} PlayerInput;
+
+// What the player can do, independent of the key or button that does it
+typedef enum InputAction {
+    ACTION_MOVE_UP,
+    ACTION_MOVE_DOWN,
+    ACTION_MOVE_LEFT,
+    ACTION_MOVE_RIGHT,
+    ACTION_BOOST,
+    ACTION_FIRE,
+    ACTION_SPECIAL,
+    ACTION_PAUSE,
+    ACTION_COUNT
+} InputAction;
+
+typedef enum BindingType {
+    BINDING_NONE,
+    BINDING_KEY,
+    BINDING_MOUSE_BUTTON,
+    BINDING_GAMEPAD_BUTTON,
+    BINDING_GAMEPAD_AXIS         // Counts as held past the deadzone in direction
+} BindingType;
+
+typedef struct Binding {
+    unsigned char type;          // BindingType
+    signed char direction;       // Axis bindings: -1 or 1
+    short code;                  // Key, mouse button, gamepad button or axis
+} Binding;
+
+// One player's bindings and the action state read through them. Updated once
+// per frame, right before the simulation consumes it.
+typedef struct InputMap {
+    Binding bindings[ACTION_COUNT][MAX_ACTION_BINDINGS];
+    int gamepad;                 // Gamepad the gamepad bindings read
+    float deadzone;
+    unsigned int down;           // Action bits held at the last update
+    unsigned int pressed;        // Action bits that went down at the last update
+} InputMap;
+
+InputMap DefaultKeyboardMap(void);
+InputMap DefaultGamepadMap(int gamepad);
+// Samples every binding; an action is pressed on the update it first reads as held
+void UpdateInputMap(InputMap *map);
+bool IsActionDown(const InputMap *map, InputAction action);
+bool IsActionPressed(const InputMap *map, InputAction action);
+PlayerInput GetPlayerInput(const InputMap *map);
+// The first key, mouse button or gamepad input that went down this frame, for
+// rebinding; mouse buttons only when mouse is set
+bool CaptureBinding(const InputMap *map, bool mouse, Binding *binding);
+const char *GetActionName(InputAction action);
+const char *GetBindingName(Binding binding);
+// Bindings persist in a text file, one line per action and player
+bool SaveInputMaps(const char *fileName, const InputMap *maps, int count);
+bool LoadInputMaps(const char *fileName, InputMap *maps, int count);
+
+// Held buttons from latest, edge buttons from every sample since the last tick
+PlayerInput MergeInput(PlayerInput pending, PlayerInput latest);
+bool InputEquals(PlayerInput a, PlayerInput b);
+
+#endif
@@ -1,73 +1,48 @@
 #include <stdio.h>
 #include "raylib.h"
+#include "ui.h"
+#include "text.h"
+#include "canvas.h"
+#include "quality.h"
+#include "effects.h"
+#include "state.h"
+#include "snapshot.h"
+#include "config.h"
+#include "ecs.h"
+#include "systems.h"
+#include "bullets.h"
+#include "flowfield.h"
+#include "rng.h"
+#include "input.h"
+#include "rollback.h"
+#include "archive.h"
+#include "drawlist.h"
+#include "director.h"
+#include "simulation.h"
+#include "watch.h"
+#include "arena.h"
+#include "tilemap.h"
+#include "buffs.h"
 #include <stdlib.h>  
 #include <math.h>    
 #include <float.h>  
 #include <errno.h>
 #include <string.h>
+#include <time.h>
 
-// gcc main.c -o main.exe -I -L -lraylib -lopengl32 -lgdi32 -lwinmm
+// gcc main.c ui.c text.c canvas.c state.c snapshot.c config.c simulation.c ecs.c systems.c bullets.c pattern.c collision.c flowfield.c rng.c input.c rollback.c mapfile.c archive.c drawlist.c director.c watch.c arena.c bitmask.c tilemap.c events.c buffs.c quality.c effects.c -o main.exe -I -L -lraylib -lopengl32 -lgdi32 -lwinmm
 // ./main.exe
 
-typedef struct GameConfig {
-    int screenWidth;
-    int screenHeight;
-    float heavyBulletCooldown;
-    float shooterCooldown;
-    float bossShootCooldown;
-    float bossSpawnCooldown;
-    int frameWidth;
-    int frameHeight;
-    int maxEnemies;
-    int maxWaves;
-    int maxEnemyBullets;
-    int maxBossBullets;
-    float frameSpeed;
-    int frameCount;
-    float waveTime;
-    float waveSpeed;
-    int waveHeight;
-    int numWavePoints;
-    int numWaves;
-    Font customFont;
-} GameConfig;
-
-typedef struct Submarine {
-    Rectangle rect;          
-    Rectangle hitbox;        
-    int speed;
-    int health;
-    int maxHealth;
-    float frameTime;
-    int currentFrame;
-    bool facingLeft;
-    float energy;
-} Submarine;
-
-typedef struct Bullet {
-    Rectangle rect;
-    bool active;
-    int damage;
-} Bullet;
-
-typedef struct Enemy {
-    Rectangle rect;
-    int speed;
-    int health;
-    int maxHealth;
-    bool active;
-    bool isShooter;
-    float shootTimer;
-    int moveDirection;
-    bool isBoss;
-    float spawnTimer;
-    float distanceMoved;
-} Enemy;
-
-typedef struct EnemyBullet {
-    Rectangle rect;
-    bool active;
-} EnemyBullet;
+// After a long stall the game slows down rather than spiral into catching up
+#define MAX_TICKS_PER_FRAME 4
+// A frame this close to a whole tick runs it now instead of holding its input for a frame
+#define TICK_SNAP (SIM_TICK * 0.125f)
+#define CONTROLS_FILE "controls.txt"
+#define TUNING_FILE "tuning.txt"
+#define WATER_TINT_ALPHA 200    // Blue fill over the scrolling water, on quality tiers that draw it
+// Memory ceilings for transient data; the debug overlay (F3) shows how much each has needed
+#define FRAME_ARENA_SIZE (512 * 1024)
+#define LEVEL_ARENA_SIZE (64 * 1024)
 
 // State of the game
 typedef enum GameState {
@@ -77,22 +52,182 @@ typedef enum GameState {
     STATE_OPTIONS,
     STATE_BUFF_SELECTION,
     STATE_BUFF_SELECTION_2,
-    STATE_VICTORY  
+    STATE_VICTORY,
+    STATE_GAME_OVER,
+    STATE_PAUSED,
+    STATE_COUNT
 } GameState;
 
+// Last values rendered into the HUD layer; a field is only redrawn when its value changes
+typedef struct HudView {
+    int health;
+    int maxHealth;
+    int energyWidth;
+    int timeTenths;
+    int wave;
+    int maxWaves;
+    int score;
+    int partnerHealth;           // -1 without a second submarine
+    int rollbackTicks;           // Ticks resimulated by the last rollback; -1 when nothing is remote
+    Rectangle healthRegion;
+    Rectangle partnerRegion;
+    Rectangle rollbackRegion;
+    Rectangle energyRegion;
+    Rectangle waveRegion;
+    Rectangle scoreRegion;
+    Rectangle timeRegion;
+    TextSystem *text;
+    int face;
+} HudView;
+
+#define BUFF_SCREEN_OFFERS 2
+
+typedef struct BuffOffer {
+    BuffId buff;
+    const char *label;
+    int fontSize;
+} BuffOffer;
+
+// The choices shown after wave 2 and before the boss; what a buff does is in buffs.c
+typedef struct BuffScreen {
+    const char *title;
+    int titleOffset;             // Left of the screen's centre
+    BuffOffer offers[BUFF_SCREEN_OFFERS];
+} BuffScreen;
+
+static const BuffScreen buffScreens[2] = {
+    { "Choose Your Buff:", 100, {
+        { BUFF_LIFESTEAL, "Lifesteal (+10 HP/Kill)", 13 },
+        { BUFF_UNLIMITED_SPECIAL, "Unlimited Special Attack", 13 } } },
+    { "Choose Your Pre-Boss Buff:", 150, {
+        { BUFF_UNLIMITED_ENERGY, "Unlimited Energy", 18 },
+        { BUFF_FULL_HEALTH, "Full Health Restore", 18 } } },
+};
+
+// Everything the state callbacks share
+typedef struct Game {
+    GameConfig config;
+    FileWatch tuningWatch;       // Saving the tuning file re-applies it between frames
+    Canvas canvas;
+    StateStack states;
+    bool quit;
+
+    Music backgroundMusic;
+    float musicVolume;
+
+    TextSystem *text;
+    int titleFace;
+    int bannerFace;
+    int headingFace;
+    int bodyFace;
+    UiContext *ui;
+    HudView hudView;
+    UiLayer hudLayer;
+
+    Texture2D backgroundMenuTexture;
+    Texture2D backgroundMenuTexture2;
+    Texture2D waterTexture;
+    SpriteAtlas atlas;
+    Texture2D submarineDetail[QUALITY_TIERS];    // The atlas draws the current tier's copy
+    QualityGovernor quality;                     // Trades presentation detail for frame time
+
+    // Submarines, enemies and every projectile live in the entity world
+    World *world;
+    BulletField enemyBullets;
+    SpriteMasks masks;
+    FlowField *flow;
+    TileMap *cavern;             // Streams the current cavern level around the screen
+    EventQueue events;           // The last tick's kills and hits
+    EffectList effects;          // Raised from each tick's events the first time it runs
+    DrawList drawList;
+
+    // Frame data, the simulation's per-tick collision lists included, is freed
+    // after every frame, level data when the wave changes
+    Arena frameArena;
+    Arena levelArena;
+    const WaveMix *wavePlan;     // In the level arena; NULL unless the director planned this wave
+    const char *levelSummary;    // In the level arena
+    bool showDebug;
+
+    // Endless mode sizes its waves from the players and the measured frame time
+    bool endless;
+    bool caverns;
+    SpawnDirector director;
+
+    // Fixed-tick simulation; the second submarine's input goes through a delayed loopback link
+    bool coop;
+    RollbackSession *rollback;
+    PlayerInput pendingInputs[MAX_PLAYERS];
+    float tickAccumulator;
+
+    // Player 1 on keyboard and mouse, player 2 on the first gamepad; both rebindable
+    InputMap inputMaps[MAX_PLAYERS];
+    int rebindPlayer;
+    int rebindAction;            // Action waiting for a new binding, -1 when none
+
+    RunState run;
+    float lowestTimes[3];
+
+    // Restart, checkpoint-at-wave and practice quick-save
+    Snapshot startSnapshot;
+    Snapshot checkpoint;
+    Snapshot quickSave;
+
+    float backgroundScrollX;
+    float scrollSpeed;
+    int scrollDirection;
+    float optionsScrollX;
+    float optionsScrollSpeed;
+    float waterScrollSpeed;
+    float waterOffset;
+} Game;
+
 // Function prototypes
-void ResetEnemies(Enemy enemies[], int enemyCount, int wave, const GameConfig* config);
-bool CheckBossWaveComplete(Enemy enemies[], const GameConfig* config);
-bool CheckCollisionWithWalls(float newX, float subY, Rectangle subRect, const GameConfig* config);
+HudView InitHudView(const GameConfig *config, TextSystem *text);
+void SyncHudView(HudView *hud, UiLayer *layer, const Health *health, const Player *player, const Health *partner, int rollbackTicks, float timer, int wave, int score);
+void DrawHudLayer(void *context, Rectangle region);
+void ResetGame(Game *game);
+bool SaveGame(void *context, Snapshot *snapshot);
+bool LoadGame(void *context, Snapshot *snapshot);
+bool RestoreGame(Game *game, Snapshot *snapshot);
+void RestartRollback(Game *game);
+void ReloadTuning(Game *game);
+void EnterLevel(Game *game, const WaveMix *plan);
+void DrawDebugOverlay(Game *game);
+void StartWave(Game *game);
+void SimulateTick(void *context, const PlayerInput *inputs);
+void DrawScrollingBackground(const Game *game, Texture2D texture, float scrollX);
+void UpdateMenu(void *context, float deltaTime);
+void DrawMenu(void *context);
+void UpdateLevelSelection(void *context, float deltaTime);
+void UpdateOptions(void *context, float deltaTime);
+void DrawOptions(void *context);
+void UpdatePlaying(void *context, float deltaTime);
+void DrawPlaying(void *context);
+void UpdateBuffSelection(void *context, float deltaTime);
+void UpdatePreBossBuffSelection(void *context, float deltaTime);
+void DrawBuffSelection(void *context);
+void EnterVictory(void *context);
+void UpdateVictory(void *context, float deltaTime);
+void DrawVictory(void *context);
+void UpdateGameOver(void *context, float deltaTime);
+void DrawGameOver(void *context);
+void UpdatePaused(void *context, float deltaTime);
+void DrawUiOverlay(void *context);
 // Function prototypes are essential in C programming as they inform the compiler about the function's name, return type, and parameters before the function is actually defined. This allows for better organization of code and helps avoid issues related to function declarations and definitions. In your code, these prototypes indicate that the functions will be implemented later in the file, and they will be used to manage enemy behavior, check for wave completion, and handle collision detection.
 
-// Function to get the bullet position based on the submarine's position
-Vector2 GetBulletPosition(Submarine sub, float bulletWidth) {
-    return (Vector2){ 
-        sub.rect.x + (sub.rect.width / 2) - (bulletWidth / 2),  
-        sub.rect.y  
-    };
-}
+// Per-state callbacks; the pause screen is an overlay, so the frozen game stays visible under it
+static const StateDesc gameStates[STATE_COUNT] = {
+    [STATE_MENU] = { .update = UpdateMenu, .draw = DrawMenu },
+    [STATE_LEVEL_SELECTION] = { .update = UpdateLevelSelection, .draw = DrawMenu },
+    [STATE_PLAYING] = { .update = UpdatePlaying, .draw = DrawPlaying },
+    [STATE_OPTIONS] = { .update = UpdateOptions, .draw = DrawOptions },
+    [STATE_BUFF_SELECTION] = { .update = UpdateBuffSelection, .draw = DrawBuffSelection },
+    [STATE_BUFF_SELECTION_2] = { .update = UpdatePreBossBuffSelection, .draw = DrawBuffSelection },
+    [STATE_VICTORY] = { .enter = EnterVictory, .update = UpdateVictory, .draw = DrawVictory },
+    [STATE_GAME_OVER] = { .update = UpdateGameOver, .draw = DrawGameOver },
+    [STATE_PAUSED] = { .update = UpdatePaused, .draw = DrawUiOverlay, .overlay = true },
+};
 
 void ReadLowestTimes(float lowestTimes[], int maxLevels) {
     FILE *file = fopen("lowestTime.txt", "r");  
@@ -132,1249 +267,999 @@ void WriteLowestTimes(float lowestTimes[], int maxLevels) {
 int main(void)
 {
     // Initialize configuration
-    GameConfig config = {
-        .screenWidth = 600,
-        .screenHeight = 800,
-        .heavyBulletCooldown = 3.0f,
-        .shooterCooldown = 1.5f,
-        .bossShootCooldown = 0.5f,
-        .bossSpawnCooldown = 5.0f,
-        .frameWidth = 64,
-        .frameHeight = 64,
-        .maxEnemies = 50,
-        .maxWaves = 5,
-        .maxEnemyBullets = 50,
-        .maxBossBullets = 100,
-        .frameSpeed = 0.1f,
-        .frameCount = 1,
-        .waveTime = 0.0f,
-        .waveSpeed = 2.0f,
-        .waveHeight = 20.0f,
-        .numWavePoints = 30,
-        .numWaves = 5,
+    Game game = {
+        .config = DefaultGameConfig(),
+        .musicVolume = 0.1f,  // Default volume set to 50%
+        .run = { .wave = 1, .maxEnemies = 5, .difficultyLevel = 1 },
+        .scrollSpeed = 2.0f,
+        .scrollDirection = 1,
+        .optionsScrollSpeed = 2.0f,
+        .waterScrollSpeed = 0.5f,
+        .inputMaps = { DefaultKeyboardMap(), DefaultGamepadMap(0) },
+        .rebindAction = -1,
     };
+    GameConfig *config = &game.config;
+
+    // Tuning overrides the defaults; a first launch writes them out as a template to edit
+    if (!LoadGameConfig(TUNING_FILE, config)) {
+        SaveGameConfig(TUNING_FILE, config);
+    }
+    WatchFile(TUNING_FILE, &game.tuningWatch);
 
     // Initialize window with config values
-    InitWindow(config.screenWidth, config.screenHeight, "Submarine Strike");
+    // The window can be any size; the game always renders to a screenWidth x screenHeight canvas
+    SetConfigFlags(FLAG_WINDOW_RESIZABLE);
+    InitWindow(config->screenWidth, config->screenHeight, "Submarine Strike");
+    SetWindowMinSize(config->screenWidth / 4, config->screenHeight / 4);
+    game.canvas = LoadCanvas(config->screenWidth, config->screenHeight, 1.0f / 60.0f);
+    game.director = CreateSpawnDirector(game.canvas.frameBudget);
+    game.quality = CreateQualityGovernor(game.canvas.frameBudget);
 
     // Initialize audio device
     InitAudioDevice();  
 
     // Load music
-    Music backgroundMusic = LoadMusicStream("music.ogg");
-    PlayMusicStream(backgroundMusic);  
-
-    // Initialize volume variable
-    float musicVolume = 0.1f;  // Default volume set to 50%
-    SetMusicVolume(backgroundMusic, musicVolume);  
-
-    config.customFont = LoadFont("fonts/Harmonic.ttf");
-
-    // Create enemy bullets array and initialize it
-    EnemyBullet enemyBullets[config.maxEnemyBullets];
-    for(int i = 0; i < config.maxEnemyBullets; i++) {
-        enemyBullets[i].active = false;
-        enemyBullets[i].rect = (Rectangle){0, 0, 0, 0};
-    }
-
-    float heavyBulletTimer = 0.0f;
-
-    // Load textures
-    Texture2D menuButtonTexture = LoadTexture("images/Button_Blue_3Slides.png");
-    Texture2D menuButtonPressedTexture = LoadTexture("images/Button_Blue_3Slides_Pressed.png");
-    Texture2D submarineSheet = LoadTexture("images/submarine.png");
-    Texture2D rocketTexture1 = LoadTexture("images/left_click_1.png");
-    Texture2D rocketTexture2 = LoadTexture("images/left_click_2.png");
-    Texture2D rocketTexture3 = LoadTexture("images/left_click_3.png");
-    Texture2D rocketTexture4 = LoadTexture("images/left_click_4.png");
-    Texture2D rocketTexture5 = LoadTexture("images/left_click_5.png");
-    Texture2D startMenuTexture = LoadTexture("images/start_menu.png");
-    Texture2D backgroundMenuTexture = LoadTexture("images/background_menu.png");
-    Texture2D backgroundMenuTexture2 = LoadTexture("images/game_background.png");
-    Texture2D normalEnemyFront = LoadTexture("images/normalEnemy_front.png");
-    Texture2D normalEnemyBack = LoadTexture("images/normalEnemy_back.png");
-    Texture2D normalEnemy2Front = LoadTexture("images/normalEnemy2_front.png");
-    Texture2D normalEnemy3Front = LoadTexture("images/normalEnemy3_front.png");
-    Texture2D normalEnemy2Back = LoadTexture("images/normalEnemy2_back.png");
-    Texture2D normalEnemy3Back = LoadTexture("images/normalEnemy3_back.png");
-    Texture2D bossTexture = LoadTexture("images/boss_pic.png");
-    Texture2D leftClickAnimationTexture = LoadTexture("images/left_click_animation.png");
-
-    Submarine sub = {
-        .rect = {
-            config.screenWidth / 2 - config.frameWidth / 2, 
-            config.screenHeight - 120,
-            (float)config.frameWidth * 1.0f,
-            (float)config.frameHeight * 2.0f
-        },
-        .hitbox = {
-            config.screenWidth / 2 - config.frameWidth / 4,  
-            config.screenHeight - 100,                 
-            (float)config.frameWidth * 1.5f,              
-            (float)config.frameHeight * 1.5f
+    game.backgroundMusic = LoadMusicStream("music.ogg");
+    PlayMusicStream(game.backgroundMusic);  
+    SetMusicVolume(game.backgroundMusic, game.musicVolume);  
+
+    // Bake the custom font at the sizes it is drawn at instead of scaling one small atlas
+    const int bakedFontSizes[] = { 32, 70 };
+    game.text = LoadTextSystem("fonts/Harmonic.ttf", bakedFontSizes, 2);
+    game.titleFace = GetTextFace(game.text, true, 70, 2);
+    game.bannerFace = GetTextFace(game.text, false, 40, 4);
+    game.headingFace = GetTextFace(game.text, false, 30, 3);
+    game.bodyFace = GetTextFace(game.text, false, 20, 2);
+
+    // Load textures from the packed archive when it was built, otherwise from the loose files
+    AssetArchive archive;
+    LoadAssetArchive("assets.pak", &archive);
+    Texture2D menuButtonTexture = LoadArchiveTexture(&archive, "images/Button_Blue_3Slides.png");
+    Texture2D menuButtonPressedTexture = LoadArchiveTexture(&archive, "images/Button_Blue_3Slides_Pressed.png");
+    Texture2D backButtonTexture = LoadArchiveTexture(&archive, "images/Button_Blue.png");
+    Texture2D backButtonPressedTexture = LoadArchiveTexture(&archive, "images/Button_Blue_Pressed.png");
+    game.backgroundMenuTexture = LoadArchiveTexture(&archive, "images/background_menu.png");
+    game.backgroundMenuTexture2 = LoadArchiveTexture(&archive, "images/game_background.png");
+    game.waterTexture = LoadArchiveTexture(&archive, "images/water_texture.png"); 
+
+    // Textures the render system draws entities with; the rocket frames animate the special attack.
+    // The submarine art is far larger than it is drawn, so it is loaded below as one copy per quality tier.
+    game.atlas = (SpriteAtlas){
+        .enemy = {
+            LoadArchiveTexture(&archive, "images/normalEnemy_front.png"),
+            LoadArchiveTexture(&archive, "images/normalEnemy2_front.png"),
+            LoadArchiveTexture(&archive, "images/normalEnemy3_front.png"),
+            LoadArchiveTexture(&archive, "images/normalEnemy_back.png"),
+            LoadArchiveTexture(&archive, "images/normalEnemy2_back.png"),
+            LoadArchiveTexture(&archive, "images/normalEnemy3_back.png")
         },
-        .speed = 200,
-        .health = 100,
-        .maxHealth = 100,
-        .frameTime = 0.0f,
-        .currentFrame = 0,
-        .facingLeft = false,
-        .energy = 100.0f
+        .rocket = {
+            LoadArchiveTexture(&archive, "images/left_click_1.png"),
+            LoadArchiveTexture(&archive, "images/left_click_2.png"),
+            LoadArchiveTexture(&archive, "images/left_click_3.png"),
+            LoadArchiveTexture(&archive, "images/left_click_4.png"),
+            LoadArchiveTexture(&archive, "images/left_click_5.png")
+        }
     };
 
-    // Create bullets
-    Bullet bullets[10];
-    for (int i = 0; i < 10; i++) {
-        bullets[i].active = false;
+    // Collision masks come from the same pixels, read before the archive is unmapped
+    static const char *enemyImageNames[ENEMY_FRAMES * 2] = {
+        "images/normalEnemy_front.png", "images/normalEnemy2_front.png", "images/normalEnemy3_front.png",
+        "images/normalEnemy_back.png", "images/normalEnemy2_back.png", "images/normalEnemy3_back.png"
+    };
+    Image submarineImage = LoadArchiveImage(&archive, "images/submarine.png");
+    Image enemyImages[ENEMY_FRAMES * 2];
+    for (int i = 0; i < ENEMY_FRAMES * 2; i++) {
+        enemyImages[i] = LoadArchiveImage(&archive, enemyImageNames[i]);
     }
+    game.masks = LoadSpriteMasks(submarineImage, enemyImages, config);
+    LoadDetailTextures(submarineImage, game.submarineDetail);
+    game.atlas.submarine = game.submarineDetail[game.quality.tier];
+    UnloadImage(submarineImage);
+    for (int i = 0; i < ENEMY_FRAMES * 2; i++) {
+        UnloadImage(enemyImages[i]);
+    }
+    UnloadAssetArchive(&archive);
+
+    game.world = LoadWorld(GetWorldCapacity(config));
+    ReserveWorld(game.world, config);
+    game.run.players[0] = SpawnPlayer(game.world, config, 0);
+    game.run.playerCount = 1;
+    game.run.stats = ResolveRunStats(game.run.buffStacks, config);
+    game.enemyBullets = LoadBulletField(config->maxBossBullets);
+    game.flow = LoadFlowField(config->screenWidth, config->screenHeight, 40.0f);
+    ReserveFlowPoints(game.flow, GetEnemyCeiling(config));
+    game.cavern = LoadTileMap(config->screenWidth, config->screenHeight);
+    game.drawList = LoadDrawList(256);
+    game.frameArena = LoadArena(FRAME_ARENA_SIZE);
+    game.levelArena = LoadArena(LEVEL_ARENA_SIZE);
+    game.levelSummary = "";
+    game.events = LoadEventQueue(GetRunEventCapacity(game.world));
+    game.rollback = LoadRollbackSession(&game, SaveGame, LoadGame, SimulateTick);
+
+    // Every restart returns to this image of the freshly loaded game
+    game.startSnapshot = LoadSnapshot(4096);
+    game.checkpoint = LoadSnapshot(4096);
+    game.quickSave = LoadSnapshot(4096);
+    SaveGame(&game, &game.startSnapshot);
+
+    ReadLowestTimes(game.lowestTimes, 3);  
+    LoadInputMaps(CONTROLS_FILE, game.inputMaps, MAX_PLAYERS);
+
+    printf("Easy: %.2f, Medium: %.2f, Hard: %.2f\n", game.lowestTimes[0], game.lowestTimes[1], game.lowestTimes[2]);
+
+    // Immediate-mode UI for menu screens and a cached layer for the in-game HUD
+    game.ui = LoadUiContext(config->screenWidth, config->screenHeight, (UiTheme){
+        .button = menuButtonTexture,
+        .buttonHot = menuButtonPressedTexture,
+        .iconButton = backButtonTexture,
+        .iconButtonHot = backButtonPressedTexture
+    }, game.text);
+    game.hudView = InitHudView(config, game.text);
+    game.hudLayer = LoadUiLayer(config->screenWidth, config->screenHeight, DrawHudLayer, &game.hudView);
+
+    game.states = CreateStateStack(gameStates, STATE_COUNT, &game, STATE_MENU);
 
-    // Create enemies array using config
-    Enemy enemies[config.maxEnemies];
-    int wave = 1;
-    int maxEnemies = wave * 5;
-    
-    // Update function calls to pass config
-    ResetEnemies(enemies, maxEnemies, wave, &config);
+    SetTargetFPS(60); 
 
-    // Game variables
-    float timer = 0.0f;  
-    bool gameOver = false;
-    bool victory = false;
-    bool startScreen = true;
+    // Main game loop
+    while (!WindowShouldClose() && !game.quit) {
+        // Update music stream
+        UpdateMusicStream(game.backgroundMusic);
 
-    int bulletIndex = 0;  
-    int score = 0;  
+        // Display controls: borderless fullscreen, scaling filter and dynamic resolution
+        if (IsKeyPressed(KEY_F11)) {
+            ToggleBorderlessWindowed();
+        }
+        if (IsKeyPressed(KEY_F10)) {
+            SetCanvasScaleMode(&game.canvas, game.canvas.scaleMode == CANVAS_SCALE_INTEGER ? CANVAS_SCALE_FIT : CANVAS_SCALE_INTEGER);
+        }
+        if (IsKeyPressed(KEY_F9)) {
+            game.canvas.dynamicResolution = !game.canvas.dynamicResolution;
+            game.canvas.level = 0;
+        }
+        if (IsKeyPressed(KEY_F7)) {
+            SetQualityGovernorEnabled(&game.quality, !game.quality.enabled);
+        }
+        if (IsKeyPressed(KEY_F3)) {
+            game.showDebug = !game.showDebug;
+        }
 
-    float backgroundScrollX = 0.0f;
-    float scrollSpeed = 2.0f;
-    int scrollDirection = 1;  
+        if (PollFileWatch(&game.tuningWatch)) {
+            ReloadTuning(&game);
+        }
 
-    GameState currentState = STATE_MENU;  
+        // Controls are sampled as late as possible, right before the states consume them
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            UpdateInputMap(&game.inputMaps[p]);
+        }
 
-    // Difficulty level variable
-    int difficultyLevel = 1;  
+        UpdateStates(&game.states, GetFrameTime());
+        DrawStates(&game.states, &game.canvas);
+        ResetArena(&game.frameArena);
+    }
 
-    SetTargetFPS(60); 
-    
-    // Define animation variables
-    const int totalFrames = 5;  
-    int currentFrame = 0;      
-    float frameTime = 0.0f;     
-    float updateTime = 0.1f;    
-
-    // Define animation variables for right-click
-    const int totalRightClickFrames = 5;  
-    Texture2D rocketTextures[5];          
-    int currentRightClickFrame = 0;       
-    float rightClickFrameTime = 0.0f;     
-    float rightClickUpdateTime = 0.1f;     
-
-    // Load the rocket textures at the beginning of your main function
-    rocketTextures[0] = LoadTexture("images/left_click_1.png");
-    rocketTextures[1] = LoadTexture("images/left_click_2.png");
-    rocketTextures[2] = LoadTexture("images/left_click_3.png");
-    rocketTextures[3] = LoadTexture("images/left_click_4.png");
-    rocketTextures[4] = LoadTexture("images/left_click_5.png");
-
-    float lowestTimes[3];  
-    ReadLowestTimes(lowestTimes, 3);  
-
-    printf("Easy: %.2f, Medium: %.2f, Hard: %.2f\n", lowestTimes[0], lowestTimes[1], lowestTimes[2]);
-
-    // Load the button textures at the beginning of your main function
-    Texture2D backButtonTexture = LoadTexture("images/Button_Blue.png");
-    Texture2D backButtonPressedTexture = LoadTexture("images/Button_Blue_Pressed.png");
-    Texture2D restartButtonTexture = LoadTexture("images/Button_Blue_3Slides.png");
-    Texture2D restartButtonPressedTexture = LoadTexture("images/Button_Blue_3Slides_Pressed.png");
-    Texture2D exitButtonTexture = LoadTexture("images/Button_Blue_3Slides.png");
-    Texture2D exitButtonPressedTexture = LoadTexture("images/Button_Blue_3Slides_Pressed.png");
-
-    // Add scrolling variables for options background
-    float optionsScrollX = 0.0f;  
-    float optionsScrollSpeed = 2.0f;  
+    CloseStates(&game.states);
+    UnloadDetailTextures(game.submarineDetail);
+    for (int i = 0; i < ENEMY_FRAMES * 2; i++) {
+        UnloadTexture(game.atlas.enemy[i]);
+    }
+    for (int i = 0; i < ROCKET_FRAMES; i++) {
+        UnloadTexture(game.atlas.rocket[i]);
+    }
+    UnloadTexture(menuButtonTexture);
+    UnloadTexture(menuButtonPressedTexture);
+    UnloadTexture(backButtonTexture);
+    UnloadTexture(backButtonPressedTexture);
+    UnloadTexture(game.backgroundMenuTexture);
+    UnloadTexture(game.backgroundMenuTexture2);
+    UnloadTexture(game.waterTexture);
+    UnloadTextSystem(game.text);
+    UnloadUiContext(game.ui);
+    UnloadUiLayer(game.hudLayer);
+    UnloadCanvas(game.canvas);
+    UnloadWorld(game.world);
+    UnloadBulletField(game.enemyBullets);
+    UnloadSpriteMasks(game.masks);
+    UnloadFlowField(game.flow);
+    UnloadTileMap(game.cavern);
+    UnloadArena(game.frameArena);
+    UnloadArena(game.levelArena);
+    UnloadEventQueue(game.events);
+    UnloadRollbackSession(game.rollback);
+    UnwatchFile(&game.tuningWatch);
+    UnloadSnapshot(game.startSnapshot);
+    UnloadSnapshot(game.checkpoint);
+    UnloadSnapshot(game.quickSave);
+    UnloadMusicStream(game.backgroundMusic);
+    CloseAudioDevice();
+    CloseWindow();
+    return 0;
+}
 
-    
+// Back to the state captured at launch: wave one, fresh submarine, no buffs
+void ResetGame(Game *game) {
+    RestoreGame(game, &game->startSnapshot);
+}
 
-    // water texture
-    Texture2D waterTexture = LoadTexture("images/water_texture.png"); 
-    float waterScrollSpeed = 0.5f; 
-    float waterOffset = 0.0f; 
+// The run carries its random generator, so the rolls after a restore replay exactly
+bool SaveGame(void *context, Snapshot *snapshot) {
+    Game *game = context;
+    ClearSnapshot(snapshot);
+    return WriteSnapshot(snapshot, &game->run, sizeof(RunState)) &&
+           SaveWorld(game->world, snapshot) &&
+           SaveBulletField(&game->enemyBullets, snapshot);
+}
 
-    // Add buff tracking variables
-    bool hasLifestealBuff = false;
-    bool hasUnlimitedRightClickBuff = false;
-    bool hasUnlimitedEnergyBuff = false;
+// Puts the simulation back to the snapshot; rollback calls this between ticks
+bool LoadGame(void *context, Snapshot *snapshot) {
+    Game *game = context;
+    if (IsSnapshotEmpty(snapshot)) return false;
+
+    RunState run;
+    RewindSnapshot(snapshot);
+    if (!ReadSnapshot(snapshot, &run, sizeof(RunState)) ||
+        !RestoreWorld(game->world, snapshot) ||
+        !RestoreBulletField(&game->enemyBullets, snapshot)) {
+        return false;
+    }
 
-    // Main game loop
-    while (!WindowShouldClose()) {
-        // Update music stream
-        UpdateMusicStream(backgroundMusic);
+    game->run = run;
+    return true;
+}
 
-        if (currentState == STATE_MENU) {
-            BeginDrawing();
-            ClearBackground(BLACK);
+// A restore from a menu also drops the tick history that led up to it
+bool RestoreGame(Game *game, Snapshot *snapshot) {
+    if (!LoadGame(game, snapshot)) return false;
+    // The snapshot may predate a tuning change
+    game->run.stats = ResolveRunStats(game->run.buffStacks, &game->config);
+    RestartRollback(game);
+    EnterLevel(game, NULL);
+    ClearEffects(&game->effects);
+    return true;
+}
 
-            // Update scroll position
-            backgroundScrollX += scrollDirection * scrollSpeed;
+void RestartRollback(Game *game) {
+    unsigned int remoteMask = (game->run.playerCount > 1) ? 0x2 : 0;
+    ResetRollbackSession(game->rollback, game->run.playerCount, remoteMask, game->config.loopbackDelay);
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        game->pendingInputs[p] = (PlayerInput){ 0 };
+    }
+    game->tickAccumulator = 0.0f;
+}
 
-            // Calculate the maximum scroll position (image width minus screen width)
-            float maxScroll = backgroundMenuTexture.width - config.screenWidth;
+// Applies the saved tuning file between frames, so no tick sees half of a change.
+// The canvas and textures were sized for the screen at launch, so that stays.
+void ReloadTuning(Game *game) {
+    GameConfig config = game->config;
+    if (!LoadGameConfig(TUNING_FILE, &config)) return;
+    config.screenWidth = game->config.screenWidth;
+    config.screenHeight = game->config.screenHeight;
+    game->config = config;
+
+    RetuneWorld(game->world, &game->config);
+    ReserveFlowPoints(game->flow, GetEnemyCeiling(&game->config));
+    ReserveEventQueue(&game->events, GetRunEventCapacity(game->world));
+    game->run.stats = ResolveRunStats(game->run.buffStacks, &game->config);
+    if (game->enemyBullets.capacity != config.maxBossBullets) {
+        ResizeBulletField(&game->enemyBullets, config.maxBossBullets);
+    }
+    if (!game->run.endless && game->hudView.maxWaves != config.maxWaves) {
+        game->hudView.maxWaves = config.maxWaves;
+        InvalidateUiRegion(&game->hudLayer, game->hudView.waveRegion);
+    }
 
-            // Check bounds and reverse direction
-            if (backgroundScrollX >= maxScroll) {
-                backgroundScrollX = maxScroll;
-                scrollDirection = -1;
-            } else if (backgroundScrollX <= 0) {
-                backgroundScrollX = 0;
-                scrollDirection = 1;
-            }
+    // Ticks already in the rollback history ran on the old values
+    RestartRollback(game);
+    printf("Reloaded %s\n", TUNING_FILE);
+}
 
-            // Draw background
-            DrawTexturePro(backgroundMenuTexture,
-                (Rectangle){ 
-                    backgroundScrollX,                    
-                    0,                                    
-                    config.screenWidth,                   
-                    backgroundMenuTexture.height           
-                },
-                (Rectangle){ 
-                    0,                                    
-                    0,                                    
-                    config.screenWidth,                   
-                    config.screenHeight                   
-                },
-                (Vector2){ 0, 0 },
-                0.0f,
-                WHITE);
-
-            // Define button rectangles
-            Rectangle startButton = { config.screenWidth / 2 - 100, config.screenHeight / 2 + 0, 200, 50 };
-            Rectangle optionsButton = { config.screenWidth / 2 - 100, config.screenHeight / 2 + 70, 200, 50 };
-            Rectangle exitButton = { config.screenWidth / 2 - 100, config.screenHeight / 2 + 140, 200, 50 };
-
-            // Check for mouse position
-            Vector2 mousePos = GetMousePosition();
-
-            // Draw buttons with hover effect
-            if (CheckCollisionPointRec(mousePos, startButton)) {
-                DrawTexture(menuButtonPressedTexture, startButton.x, startButton.y, WHITE);
-            } else {
-                DrawTexture(menuButtonTexture, startButton.x, startButton.y, WHITE);
-            }
+// Level data from the previous wave is released; what the new one keeps goes
+// in the level arena. plan is the director's plan for a wave StartWave just
+// spawned; a restore or a wave started inside the simulation has none.
+void EnterLevel(Game *game, const WaveMix *plan) {
+    const RunState *run = &game->run;
+    int enemies = CountEntities(game->world, HAS_HEALTH | HAS_ENEMY, 0);
+
+    ResetArena(&game->levelArena);
+    game->wavePlan = NULL;
+    if (plan) {
+        WaveMix *kept = ArenaAlloc(&game->levelArena, sizeof(WaveMix));
+        if (kept) {
+            *kept = *plan;
+            game->wavePlan = kept;
+        }
+    }
 
-            if (CheckCollisionPointRec(mousePos, optionsButton)) {
-                DrawTexture(menuButtonPressedTexture, optionsButton.x, optionsButton.y, WHITE);
-            } else {
-                DrawTexture(menuButtonTexture, optionsButton.x, optionsButton.y, WHITE);
-            }
+    if (run->endless && game->wavePlan) {
+        const WaveMix *mix = game->wavePlan;
+        game->levelSummary = ArenaFormat(&game->levelArena,
+            "Endless wave %d: %d enemies (%d patrol, %d chase, %d shoot, health %d, speed %.2f), intensity %.2f, capacity %d",
+            run->wave, enemies, mix->patrollers, mix->chasers, mix->shooters, mix->health, mix->speed,
+            game->director.intensity, GetDirectorCapacity(&game->director));
+    } else if (run->endless) {
+        game->levelSummary = ArenaFormat(&game->levelArena, "Endless wave %d: %d enemies, intensity %.2f, capacity %d",
+            run->wave, enemies, game->director.intensity, GetDirectorCapacity(&game->director));
+    } else {
+        game->levelSummary = ArenaFormat(&game->levelArena, "Wave %d of %d: %d enemies", run->wave, game->config.maxWaves, enemies);
+    }
+}
 
-            if (CheckCollisionPointRec(mousePos, exitButton)) {
-                DrawTexture(menuButtonPressedTexture, exitButton.x, exitButton.y, WHITE);
-            } else {
-                DrawTexture(menuButtonTexture, exitButton.x, exitButton.y, WHITE);
-            }
+// How the wave that is ending went, for the spawn director
+static WaveReport GetWaveReport(Game *game) {
+    WaveReport report = { game->run.waveEnemies, game->run.timer - game->run.waveStartTime, 0.0f };
+    int alive = 0;
+    for (int p = 0; p < game->run.playerCount; p++) {
+        const Health *health = GetComponent(game->world, game->run.players[p], COMPONENT_HEALTH);
+        if (health->current <= 0) continue;
+        report.healthFraction += (float)health->current / health->max;
+        alive++;
+    }
+    if (alive > 0) report.healthFraction /= alive;
+    return report;
+}
 
-            // Draw button text
-            DrawText("Start", startButton.x + 60, startButton.y + 10, 20, WHITE);
-            DrawText("Settings", optionsButton.x + 60, optionsButton.y + 10, 20, WHITE);
-            DrawText("Exit", exitButton.x + 80, exitButton.y + 10, 20, WHITE);
-
-            // Check for button clicks
-            if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                if (CheckCollisionPointRec(mousePos, startButton)) {
-                    currentState = STATE_LEVEL_SELECTION; 
-                } else if (CheckCollisionPointRec(mousePos, optionsButton)) {
-                    currentState = STATE_OPTIONS; // Go to options
-                } else if (CheckCollisionPointRec(mousePos, exitButton)) {
-                    CloseWindow(); // Exit the game
-                }
-            }
+// Spawns the current wave and checkpoints it for retries. Buffs picked on the
+// menu before it changed the state outside the simulation, so history restarts here.
+void StartWave(Game *game) {
+    RunState *run = &game->run;
+    WaveMix mix = { 0 };
 
-            DrawTextEx(config.customFont, "SUBMARINE STRIKE", (Vector2){config.screenWidth / 2 - 260, config.screenHeight / 2 - 100}, 70, 2, DARKBLUE);
+    if (run->endless) {
+        mix = PlanEndlessWave(&game->director, run->wave, run->difficultyLevel, GetWaveReport(game));
+        run->waveEnemies = mix.patrollers + mix.chasers + mix.shooters;
+        SpawnWaveMix(game->world, &run->rng, mix, &game->config);
+    } else {
+        SpawnWave(game->world, &run->rng, run->wave, run->maxEnemies, run->difficultyLevel, &game->config);
+    }
 
-            EndDrawing();
-        } else if (currentState == STATE_LEVEL_SELECTION) {
-            backgroundScrollX += scrollSpeed;
-            if (backgroundScrollX >= config.screenWidth) {
-                backgroundScrollX = 0;  
-            }
+    run->waveStartTime = run->timer;
+    EnterLevel(game, run->endless ? &mix : NULL);
+    SaveGame(game, &game->checkpoint);
+    RestartRollback(game);
+}
 
-            BeginDrawing();
-            
-            // Draw the scrolling background
-            DrawTexturePro(backgroundMenuTexture,
-                (Rectangle){ backgroundScrollX, 0, config.screenWidth, backgroundMenuTexture.height },
-                (Rectangle){ 0, 0, config.screenWidth, config.screenHeight },
-                (Vector2){ 0, 0 },
-                0.0f,
-                WHITE);
-            
-            // Draw the title
-            DrawText("Select Difficulty Level:", config.screenWidth / 2 - 100, config.screenHeight / 2 - 50, 20, GRAY);
-            
-            // Define clickable areas for each button (easy, medium, hard)
-            Rectangle easyButton = { config.screenWidth / 2 - 100, config.screenHeight / 2 + 0, 200, 50 };
-            Rectangle mediumButton = { config.screenWidth / 2 - 100, config.screenHeight / 2 + 70, 200, 50 };
-            Rectangle hardButton = { config.screenWidth / 2 - 100, config.screenHeight / 2 + 140, 200, 50 };
-
-            // Check for mouse position
-            Vector2 mousePos = GetMousePosition();
-
-            // Draw buttons with hover effect
-            if (CheckCollisionPointRec(mousePos, easyButton)) {
-                DrawTexture(menuButtonPressedTexture, easyButton.x, easyButton.y, WHITE); 
-            } else {
-                DrawTexture(menuButtonTexture, easyButton.x, easyButton.y, WHITE); 
-            }
-            DrawText("Easy", easyButton.x + 60, easyButton.y + 10, 20, WHITE); 
-            DrawText(TextFormat("Fastest Time: %.2f", lowestTimes[0]), easyButton.x + 200, easyButton.y + 20, 20, GRAY); 
+// Rollback's tick callback
+void SimulateTick(void *context, const PlayerInput *inputs) {
+    Game *game = context;
+    StepRun(&game->run, game->world, &game->enemyBullets, game->flow, &game->masks, game->cavern, &game->events, &game->frameArena, &game->config, inputs);
+    if (!game->rollback->resimulating) {
+        AddEventEffects(&game->effects, &game->events);
+    }
+}
 
-            if (CheckCollisionPointRec(mousePos, mediumButton)) {
-                DrawTexture(menuButtonPressedTexture, mediumButton.x, mediumButton.y, WHITE); 
-            } else {
-                DrawTexture(menuButtonTexture, mediumButton.x, mediumButton.y, WHITE); 
-            }
-            DrawText("Medium", mediumButton.x + 60, mediumButton.y + 10, 20, WHITE); 
-            DrawText(TextFormat("Fastest Time: %.2f", lowestTimes[1]), mediumButton.x + 200, mediumButton.y + 20, 20, GRAY); 
+void DrawScrollingBackground(const Game *game, Texture2D texture, float scrollX) {
+    DrawTexturePro(texture,
+        (Rectangle){ scrollX, 0, game->config.screenWidth, texture.height },
+        (Rectangle){ 0, 0, game->config.screenWidth, game->config.screenHeight },
+        (Vector2){ 0, 0 },
+        0.0f,
+        WHITE);
+}
 
-            if (CheckCollisionPointRec(mousePos, hardButton)) {
-                DrawTexture(menuButtonPressedTexture, hardButton.x, hardButton.y, WHITE); 
-            } else {
-                DrawTexture(menuButtonTexture, hardButton.x, hardButton.y, WHITE); 
-            }
-            DrawText("Hard", hardButton.x + 60, hardButton.y + 10, 20, WHITE); 
-            DrawText(TextFormat("Fastest Time: %.2f", lowestTimes[2]), hardButton.x + 200, hardButton.y + 20, 20, GRAY); 
+void UpdateMenu(void *context, float deltaTime) {
+    Game *game = context;
+    const GameConfig *config = &game->config;
+    UiContext *ui = game->ui;
 
-            Rectangle backButton = {10, 10, 60, 55};  
+    // Update scroll position
+    game->backgroundScrollX += game->scrollDirection * game->scrollSpeed;
 
-            // Draw the back button with hover effect
-            if (CheckCollisionPointRec(mousePos, backButton)) {
-                DrawTexture(backButtonPressedTexture, backButton.x, backButton.y, WHITE); 
-            } else {
-                DrawTexture(backButtonTexture, backButton.x, backButton.y, WHITE); 
-            }
+    // Calculate the maximum scroll position (image width minus screen width)
+    float maxScroll = game->backgroundMenuTexture.width - config->screenWidth;
 
-            DrawText("←", backButton.x + backButton.width / 2 - 10, backButton.y + backButton.height / 2 - 10, 20, WHITE); 
+    // Check bounds and reverse direction
+    if (game->backgroundScrollX >= maxScroll) {
+        game->backgroundScrollX = maxScroll;
+        game->scrollDirection = -1;
+    } else if (game->backgroundScrollX <= 0) {
+        game->backgroundScrollX = 0;
+        game->scrollDirection = 1;
+    }
 
-            // Check for button clicks to exit
-            if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && CheckCollisionPointRec(mousePos, backButton)) {
-                currentState = STATE_MENU;
-            }
+    Rectangle startButton = { config->screenWidth / 2 - 100, config->screenHeight / 2 + 0, 200, 50 };
+    Rectangle optionsButton = { config->screenWidth / 2 - 100, config->screenHeight / 2 + 70, 200, 50 };
+    Rectangle exitButton = { config->screenWidth / 2 - 100, config->screenHeight / 2 + 140, 200, 50 };
 
-            // Check button clicks for difficulty selection
-            if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-                if (CheckCollisionPointRec(mousePos, easyButton)) {
-                    difficultyLevel = 1;  
-                    currentState = STATE_PLAYING;  
-                } else if (CheckCollisionPointRec(mousePos, mediumButton)) {
-                    difficultyLevel = 2;  
-                    currentState = STATE_PLAYING;  
-                } else if (CheckCollisionPointRec(mousePos, hardButton)) {
-                    difficultyLevel = 3;  
-                    currentState = STATE_PLAYING;  
-                }
-            }
+    UiBegin(ui, STATE_MENU);
+    UiLabelEx(ui, game->titleFace, "SUBMARINE STRIKE", (Vector2){config->screenWidth / 2 - 260, config->screenHeight / 2 - 100}, DARKBLUE);
+    if (UiButton(ui, startButton, "Start", 20)) {
+        PushState(&game->states, STATE_LEVEL_SELECTION);
+    }
+    if (UiButton(ui, optionsButton, "Settings", 20)) {
+        PushState(&game->states, STATE_OPTIONS); // Go to options
+    }
+    if (UiButton(ui, exitButton, "Exit", 20)) {
+        game->quit = true; // Exit the game
+    }
+    UiEnd(ui);
+}
 
-            EndDrawing();
-        } else if (currentState == STATE_PLAYING) {
-            // Update the water offset for scrolling
-            waterOffset += waterScrollSpeed * GetFrameTime();
-            if (waterOffset >= waterTexture.height) {
-                waterOffset = 0; // Reset the offset to create a loop
-            }
+// Menu and level selection share the scrolling background
+void DrawMenu(void *context) {
+    Game *game = context;
+    DrawScrollingBackground(game, game->backgroundMenuTexture, game->backgroundScrollX);
+    AddCanvasOverlay(&game->canvas, &game->ui->layer);
+}
 
-            // Draw the moving water background
-            DrawTexturePro(waterTexture,
-                (Rectangle){ 0, waterOffset, waterTexture.width, waterTexture.height - waterOffset }, // Top part
-                (Rectangle){ 0, 0, config.screenWidth, config.screenHeight }, // Destination rectangle
-                (Vector2){ 0, 0 }, // Origin
-                0.0f, // Rotation
-                WHITE); // Color
-
-            DrawTexturePro(waterTexture,
-                (Rectangle){ 0, 0, waterTexture.width, waterOffset }, // Bottom part
-                (Rectangle){ 0, config.screenHeight - waterOffset, config.screenWidth, waterOffset }, // Destination rectangle
-                (Vector2){ 0, 0 }, // Origin
-                0.0f, // Rotation
-                WHITE); // Color
-
-            // Update the timer
-            timer += GetFrameTime();  
-
-            // Start the game with the selected difficulty level
-            // Adjust game parameters based on difficultyLevel
-            if (difficultyLevel == 1) {  // Easy
-                // Set parameters for easy level
-                for (int i = 0; i < maxEnemies; i++) {
-                    enemies[i].speed = 1;  
-                    enemies[i].maxHealth = 1;  
-                }
-            } else if (difficultyLevel == 2) {  
-                // Set parameters for medium level
-                for (int i = 0; i < maxEnemies; i++) {
-                    enemies[i].speed = 2;  
-                    enemies[i].maxHealth = 2;  
-                }
-            } else if (difficultyLevel == 3) {  
-                // Set parameters for hard level
-                for (int i = 0; i < maxEnemies; i++) {
-                    enemies[i].speed = 3;  
-                    enemies[i].maxHealth = 3;  
-                }
-            }
+void UpdateLevelSelection(void *context, float deltaTime) {
+    Game *game = context;
+    const GameConfig *config = &game->config;
+    UiContext *ui = game->ui;
 
-            // Regular game drawing
-            BeginDrawing();
-            
-            // Update scroll position for game background
-            backgroundScrollX += scrollSpeed;
-            if (backgroundScrollX >= backgroundMenuTexture2.width - config.screenWidth) {
-                backgroundScrollX = 0;
-            }
+    game->backgroundScrollX += game->scrollSpeed;
+    if (game->backgroundScrollX >= config->screenWidth) {
+        game->backgroundScrollX = 0;  
+    }
 
-            // Update wave time
-            config.waveTime += GetFrameTime() * config.waveSpeed;
-
-            // Background colour
-            DrawRectangle(0, 0, config.screenWidth, config.screenHeight, (Color){0, 105, 148, 255});  
-
-            // Victory screen logic
-            if (victory) {
-                BeginDrawing();
-                DrawTexturePro(backgroundMenuTexture,  // Use the background menu texture
-                (Rectangle){ 
-                    backgroundScrollX, 
-                    0, 
-                    config.screenWidth, 
-                    backgroundMenuTexture.height 
-                },
-                (Rectangle){ 
-                    0, 
-                    0, 
-                    config.screenWidth, 
-                    config.screenHeight 
-                },
-                (Vector2){ 0, 0 },
-                0.0f,
-                WHITE);
-
-                float newTime = timer;
-                if (newTime < lowestTimes[difficultyLevel - 1]) {
-                    lowestTimes[difficultyLevel - 1] = newTime;
-                    WriteLowestTimes(lowestTimes, 3);  // Write the new times to file
-                }
-
-                DrawText("VICTORY!", config.screenWidth / 2 - 120, config.screenHeight / 2 - 100, 40, GREEN);
-                DrawText("You completed all 5 waves!", config.screenWidth / 2 - 190, config.screenHeight / 2, 30, BLACK);
-
-                DrawText("Press Enter to restart or Esc to exit", config.screenWidth / 2 - 200, config.screenHeight / 2 + 30, 20, BLACK);
-                
-                EndDrawing();
-
-                if (IsKeyPressed(KEY_ENTER)) {
-                    // Write the times to file before resetting
-                    WriteLowestTimes(lowestTimes, 3);
-                    
-                    // Reset all game variables
-                    timer = 0.0f;
-                    wave = 1;
-                    maxEnemies = wave * 5;
-                    sub.speed = 200;
-                    sub.health = sub.maxHealth;
-                    sub.energy = 100.0f;
-                    ResetEnemies(enemies, maxEnemies, wave, &config);
-                    victory = false;
-                    gameOver = false; 
-                    currentState = STATE_LEVEL_SELECTION;
-                } else if (IsKeyPressed(KEY_ESCAPE)) {
-                    CloseWindow(); // Exit the game
-                }
-
-                continue;  
+    // Define clickable areas for each button (easy, medium, hard)
+    const char *difficultyNames[] = { "Easy", "Medium", "Hard" };
+    Rectangle cavernButton = { config->screenWidth / 2 - 100, config->screenHeight / 2 - 260, 200, 50 };
+    Rectangle modeButton = { config->screenWidth / 2 - 100, config->screenHeight / 2 - 190, 200, 50 };
+    Rectangle coopButton = { config->screenWidth / 2 - 100, config->screenHeight / 2 - 120, 200, 50 };
+    UiBegin(ui, STATE_LEVEL_SELECTION);
+    if (UiButton(ui, cavernButton, game->caverns ? "Caverns: On" : "Caverns: Off", 20)) {
+        game->caverns = !game->caverns;
+    }
+    if (UiButton(ui, modeButton, game->endless ? "Mode: Endless" : "Mode: Campaign", 20)) {
+        game->endless = !game->endless;
+    }
+    if (UiButton(ui, coopButton, game->coop ? "Co-op: On" : "Co-op: Off", 20)) {
+        game->coop = !game->coop;
+    }
+    UiLabel(ui, "Select Difficulty Level:", config->screenWidth / 2 - 100, config->screenHeight / 2 - 50, 20, GRAY);
+    for (int i = 0; i < 3; i++) {
+        Rectangle button = { config->screenWidth / 2 - 100, config->screenHeight / 2 + 70 * i, 200, 50 };
+        if (UiButton(ui, button, difficultyNames[i], 20)) {
+            // The second submarine joins on a gamepad
+            if (game->coop && game->run.playerCount == 1) {
+                game->run.players[1] = SpawnPlayer(game->world, config, 1);
+                game->run.playerCount = 2;
             }
-
-            // Game over logic
-            if (gameOver) {
-                BeginDrawing();
-                DrawTexturePro(backgroundMenuTexture, 
-                    (Rectangle){ 
-                        backgroundScrollX, 
-                        0, 
-                        config.screenWidth, 
-                        backgroundMenuTexture.height 
-                    },
-                    (Rectangle){ 
-                        0, 
-                        0, 
-                        config.screenWidth, 
-                        config.screenHeight 
-                    },
-                    (Vector2){ 0, 0 },
-                    0.0f,
-                    WHITE);
-                
-                DrawText("Game Over!", config.screenWidth / 2 - 100, config.screenHeight / 2 - 50, 40, RED);
-                DrawText("Press Enter to restart or Esc to exit", config.screenWidth / 2 - 200, config.screenHeight / 2, 20, BLACK);
-                
-                EndDrawing();
-
-                if (IsKeyPressed(KEY_ENTER)) {
-                    // Reset game variables and state
-                    timer = 0.0f;
-                    wave = 1;
-                    maxEnemies = wave * 5;
-                    sub.speed = 200;
-                    sub.health = sub.maxHealth;
-                    sub.energy = 100.0f;
-                    ResetEnemies(enemies, maxEnemies, wave, &config);
-                    gameOver = false;
-                    currentState = STATE_LEVEL_SELECTION;
-                } else if (IsKeyPressed(KEY_ESCAPE)) {
-                    CloseWindow(); // Exit the game
-                }
-
-                continue;  
+            game->run.difficultyLevel = i + 1;
+            game->run.endless = game->endless;
+            game->run.rng = SeedRng((unsigned int)time(NULL));
+            game->run.cavern = (CavernState){ 0 };
+            if (game->caverns && game->cavern != NULL) {
+                game->run.cavern = (CavernState){ true, NextRng(&game->run.rng), config->cavernRows, 0.0f };
+                game->run.cavern.top = GetTileMapStart(game->cavern, config->cavernRows);
             }
+            RestartSpawnDirector(&game->director);
+            game->hudView.maxWaves = game->endless ? 0 : config->maxWaves;
+            InvalidateUiRegion(&game->hudLayer, game->hudView.waveRegion);
+            StartWave(game);
+            ResetStates(&game->states, STATE_PLAYING);
+        }
+        UiLabel(ui, ArenaFormat(&game->frameArena, "Fastest Time: %.2f", game->lowestTimes[i]), button.x + 200, button.y + 20, 20, GRAY);
+    }
+    if (UiIconButton(ui, (Rectangle){10, 10, 60, 55}, "←")) {
+        PopState(&game->states);
+    }
+    UiEnd(ui);
+}
 
-            // Update cooldown timer
-            heavyBulletTimer -= GetFrameTime();
+void UpdateOptions(void *context, float deltaTime) {
+    Game *game = context;
+    const GameConfig *config = &game->config;
+    UiContext *ui = game->ui;
 
-            if (IsKeyDown(KEY_A)) {
-                sub.facingLeft = true;
-            }
+    // Update scroll position for options background
+    game->optionsScrollX += game->optionsScrollSpeed;
+    if (game->optionsScrollX >= game->backgroundMenuTexture.width) {
+        game->optionsScrollX = 0;  
+    }
 
-            if (IsKeyDown(KEY_D)) {
-                sub.facingLeft = false;
-            }
+    UiBegin(ui, STATE_OPTIONS);
 
-            // Submarine movement
-            if (IsKeyDown(KEY_W) && sub.rect.y > 0) { 
-                sub.rect.y -= sub.speed * GetFrameTime();
-            }
-            if (IsKeyDown(KEY_S) && sub.rect.y + sub.rect.height < config.screenHeight) { 
-                sub.rect.y += sub.speed * GetFrameTime();
-            }
-            if (IsKeyDown(KEY_A) && sub.rect.x > 0) { 
-                sub.rect.x -= sub.speed * GetFrameTime();
-            }
-            if (IsKeyDown(KEY_D) && sub.rect.x + sub.rect.width < config.screenWidth) { 
-                sub.rect.x += sub.speed * GetFrameTime();
-            }
+    // While a binding is being changed, the next input goes to it instead of the menu.
+    // Clicks on a widget are never bound: one cancels the change and reaches the widget.
+    bool overWidget = ui->hot >= 0;
+    if (game->rebindAction >= 0 && overWidget && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+        game->rebindAction = -1;
+    }
+    bool capturing = game->rebindAction >= 0;
+    if (capturing) {
+        Binding *binding = &game->inputMaps[game->rebindPlayer].bindings[game->rebindAction][0];
+        Binding captured;
+        bool done = true;
+        if (IsKeyPressed(KEY_BACKSPACE)) {
+            *binding = (Binding){ BINDING_NONE };
+        } else if (CaptureBinding(&game->inputMaps[game->rebindPlayer], !overWidget, &captured)) {
+            *binding = captured;
+        } else {
+            done = false;
+        }
+        if (done) {
+            game->rebindAction = -1;
+            SaveInputMaps(CONTROLS_FILE, game->inputMaps, MAX_PLAYERS);
+        }
+    }
 
-            // Speed boost logic
-            if (IsKeyDown(KEY_D) && IsKeyDown(KEY_LEFT_SHIFT) && sub.rect.x + sub.rect.width < config.screenWidth) {
-                if (hasUnlimitedEnergyBuff || sub.energy > 0) {  
-                    sub.rect.x += (sub.speed + 5) * GetFrameTime(); 
-                    if (!hasUnlimitedEnergyBuff) {
-                        sub.energy -= 1.0f;  
-                    }
-                }
+    // Draw the settings title and a binding per action and player
+    UiLabel(ui, "Settings", config->screenWidth / 2 - 50, 50, 30, WHITE);
+    UiLabel(ui, "Controls", 40, 100, 20, WHITE);
+    UiLabel(ui, "Player 1", 250, 100, 20, WHITE);
+    UiLabel(ui, "Player 2", 430, 100, 20, WHITE);
+    for (int a = 0; a < ACTION_COUNT; a++) {
+        int y = 125 + 30 * a;
+        UiLabel(ui, GetActionName(a), 40, y + 3, 20, WHITE);
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            Rectangle button = { 220 + 180 * p, y, 170, 26 };
+            bool waiting = game->rebindAction == a && game->rebindPlayer == p;
+            const char *name = waiting ? "Press a key..." : GetBindingName(game->inputMaps[p].bindings[a][0]);
+            if (UiButton(ui, button, name, 16) && !capturing) {
+                game->rebindPlayer = p;
+                game->rebindAction = a;
             }
+        }
+    }
+    UiLabel(ui, "Click a binding to change it, Backspace clears", 40, 370, 16, WHITE);
+    UiLabel(ui, "Quick Save / Load: F5 / F8   Debug Overlay: F3", 40, 395, 20, WHITE);
+    UiLabel(ui, "Exit Game: Esc", 40, 415, 20, WHITE);
+
+    // Volume Slider
+    UiLabel(ui, "Music Volume:", 40, 445, 20, WHITE);
+    if (UiSlider(ui, (Rectangle){ 40, 475, 200, 20 }, &game->musicVolume)) {
+        SetMusicVolume(game->backgroundMusic, game->musicVolume);
+    }
 
-            if (IsKeyDown(KEY_A) && IsKeyDown(KEY_LEFT_SHIFT) && sub.rect.x > 0) {
-                if (hasUnlimitedEnergyBuff || sub.energy > 0) {  
-                    sub.rect.x -= (sub.speed + 5) * GetFrameTime(); 
-                    if (!hasUnlimitedEnergyBuff) {
-                        sub.energy -= 1.0f;  
-                    }
-                }
-            }
+    // Display
+    UiLabel(ui, "Display", 40, 515, 20, WHITE);
+    UiLabel(ui, "Borderless Fullscreen: F11", 40, 545, 20, WHITE);
+    UiLabel(ui, ArenaFormat(&game->frameArena, "Scaling (F10): %s", game->canvas.scaleMode == CANVAS_SCALE_INTEGER ? "Pixel Perfect" : "Fit to Window"), 40, 565, 20, WHITE);
+    UiLabel(ui, ArenaFormat(&game->frameArena, "Dynamic Resolution (F9): %s", game->canvas.dynamicResolution ? "On" : "Off"), 40, 585, 20, WHITE);
+    UiLabel(ui, ArenaFormat(&game->frameArena, "Adaptive Quality (F7): %s", game->quality.enabled ? "On" : "Off"), 40, 605, 20, WHITE);
+
+    // Back button returns to whichever screen opened the settings
+    if (UiIconButton(ui, (Rectangle){10, 10, 60, 55}, "←") && !capturing) {
+        game->rebindAction = -1;
+        PopState(&game->states);
+    }
+    UiEnd(ui);
+}
 
-            // Update hitbox position after movement
-            sub.hitbox.x = sub.rect.x + (sub.rect.width - sub.hitbox.width) / 2; 
-
-            // Shooting bullets
-            if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-                if (!bullets[bulletIndex].active) {
-                    Vector2 bulletPos = GetBulletPosition(sub, 5);  
-                    bullets[bulletIndex].rect.x = bulletPos.x;
-                    bullets[bulletIndex].rect.y = bulletPos.y;
-                    bullets[bulletIndex].rect.width = 5;
-                    bullets[bulletIndex].rect.height = 10;
-                    bullets[bulletIndex].active = true;
-                    bullets[bulletIndex].damage = 1;  
-                    bulletIndex = (bulletIndex + 1) % 10; 
-                }
-            }
+void DrawOptions(void *context) {
+    Game *game = context;
+    DrawScrollingBackground(game, game->backgroundMenuTexture, game->optionsScrollX);
+    AddCanvasOverlay(&game->canvas, &game->ui->layer);
+}
 
-            if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT) && (heavyBulletTimer <= 0 || hasUnlimitedRightClickBuff)) {
-                if (!bullets[bulletIndex].active) {
-                    Vector2 bulletPos = GetBulletPosition(sub, 100);
-                    bullets[bulletIndex].rect.x = bulletPos.x + 25.0f;
-                    bullets[bulletIndex].rect.y = bulletPos.y;
-                    bullets[bulletIndex].active = true;
-                    bullets[bulletIndex].damage = 3;
-                    bullets[bulletIndex].rect.width = 100;
-                    bullets[bulletIndex].rect.height = 100;
-                    currentRightClickFrame = 0;
-                    rightClickFrameTime = 0.0f;
-                    bulletIndex = (bulletIndex + 1) % 10;
-                    
-                    // Only apply cooldown if we don't have unlimited right-click
-                    if (!hasUnlimitedRightClickBuff) {
-                        heavyBulletTimer = config.heavyBulletCooldown;
-                    }
-                }
-            }
+void UpdatePlaying(void *context, float deltaTime) {
+    Game *game = context;
+    GameConfig *config = &game->config;
+    World *world = game->world;
 
-            // Update right-click bullet animation frame
-            if (bullets[bulletIndex].active) {
-                rightClickFrameTime += GetFrameTime();
-                if (rightClickFrameTime >= rightClickUpdateTime) {
-                    rightClickFrameTime = 0.0f;
-                    currentRightClickFrame = (currentRightClickFrame + 1) % totalRightClickFrames; 
-                }
-            }
+    if (IsActionPressed(&game->inputMaps[0], ACTION_PAUSE) || IsActionPressed(&game->inputMaps[1], ACTION_PAUSE)) {
+        PushState(&game->states, STATE_PAUSED);
+        return;
+    }
 
-            // Draw the right-click bullet with the current texture
-            for (int i = 0; i < 10; i++) {  
-                if (bullets[i].active && bullets[i].rect.width > 5) {  
-                    DrawTexturePro(rocketTextures[currentRightClickFrame],
-                        (Rectangle){ 0, 0, rocketTextures[currentRightClickFrame].width, rocketTextures[currentRightClickFrame].height },
-                        (Rectangle){ 
-                            bullets[i].rect.x, 
-                            bullets[i].rect.y,
-                            bullets[i].rect.width * 0.5f,    
-                            bullets[i].rect.height * 0.5f    
-                        },
-                        (Vector2){ 0, 0 },
-                        270.0f,    
-                        WHITE);
-                }
-            }
+    // Practice: quick-save anywhere and jump back to it
+    if (IsKeyPressed(KEY_F5)) {
+        SaveGame(game, &game->quickSave);
+    }
+    if (IsKeyPressed(KEY_F8) && RestoreGame(game, &game->quickSave)) {
+        game->run.practice = true;
+    }
 
-            // Update bullet positions
-            for (int i = 0; i < 10; i++) {
-                if (bullets[i].active) {
-                    bullets[i].rect.y -= 10;
-                    if (bullets[i].rect.y < 0) bullets[i].active = false; 
-                }
-            }
+    UpdateEffects(&game->effects, deltaTime);
 
-            // Update enemies
-            for (int i = 0; i < maxEnemies; i++) {
-                if (enemies[i].active) {
-                    if (enemies[i].isBoss) {
-                        // Boss horizontal movement
-                        enemies[i].rect.x += enemies[i].moveDirection * enemies[i].speed;  // Use enemy speed
-                        if (enemies[i].rect.x <= 0 || enemies[i].rect.x + enemies[i].rect.width >= config.screenWidth) {
-                            enemies[i].moveDirection *= -1;
-                        }
-
-                        // Boss shooting
-                        enemies[i].shootTimer -= GetFrameTime();
-                        if (enemies[i].shootTimer <= 0) {
-                            // Find an inactive bullet
-                            for (int j = 0; j < config.maxEnemyBullets; j++) {
-                                if (!enemyBullets[j].active) {
-                                    enemyBullets[j].rect.x = enemies[i].rect.x + enemies[i].rect.width/2;
-                                    enemyBullets[j].rect.y = enemies[i].rect.y + enemies[i].rect.height;
-                                    enemyBullets[j].rect.width = 10;
-                                    enemyBullets[j].rect.height = 10;
-                                    enemyBullets[j].active = true;
-                                    enemies[i].shootTimer = config.bossShootCooldown;
-                                    break;
-                                }
-                            }
-                        }
-
-                    } else if (enemies[i].isShooter) {
-
-                        // Shooter enemy behavior
-                        enemies[i].rect.x += enemies[i].moveDirection * 2; 
-
-                        // Reverse direction if it hits the screen edges
-                        if (enemies[i].rect.x <= 0 || enemies[i].rect.x + enemies[i].rect.width >= config.screenWidth) {
-                            enemies[i].moveDirection *= -1;
-                        }
-
-                        // Shooting logic
-                        enemies[i].shootTimer -= GetFrameTime();
-                        if (enemies[i].shootTimer <= 0) {
-                            for (int j = 0; j < config.maxEnemyBullets; j++) {
-                                if (!enemyBullets[j].active) {
-                                    enemyBullets[j].rect.x = enemies[i].rect.x + enemies[i].rect.width / 2;
-                                    enemyBullets[j].rect.y = enemies[i].rect.y + enemies[i].rect.height;
-                                    enemyBullets[j].rect.width = 5;
-                                    enemyBullets[j].rect.height = 10;
-                                    enemyBullets[j].active = true;
-                                    enemies[i].shootTimer = config.shooterCooldown;
-                                    break;
-                                }
-                            }
-                        }
-                    } else {
-                        // Modified normal enemy behavior to bounce
-                        enemies[i].rect.y += enemies[i].speed * enemies[i].moveDirection;
-                        
-                        // Bounce at bottom and top of screen
-                        if (enemies[i].rect.y + enemies[i].rect.height >= config.screenHeight || 
-                            enemies[i].rect.y <= 0) {
-                            enemies[i].moveDirection *= -1;  
-                        }
-                    }
-
-                    // Collision checks with player
-                    if (CheckCollisionRecs(sub.hitbox, enemies[i].rect)) {
-                        if (wave == 5) {
-                            sub.health = 0;  
-                        } else {
-                            sub.health -= 20;  
-                        }
-                        if (wave != 5) {  
-                            enemies[i].active = false;
-                        }
-                    }
-
-                    // Bullet collision detect
-                    for (int j = 0; j < 10; j++) {
-                        if (bullets[j].active && CheckCollisionRecs(bullets[j].rect, enemies[i].rect)) {
-                            if (bullets[j].rect.width <= 5) {
-                                bullets[j].active = false;  
-                            } else if (bullets[j].rect.width == 100) {  
-                                bullets[j].active = false;  
-                            }
-                            
-                            enemies[i].health -= bullets[j].damage;
-                            if (enemies[i].health <= 0) {
-                                if (wave == 5 && enemies[i].isBoss) {
-                                    victory = true;
-                                }
-                                enemies[i].active = false;
-                                score += 10;
-                                sub.energy += 25;
-                                if (sub.energy > 100.0f) {  
-                                    sub.energy = 100.0f;
-                                }
-
-                                // Add lifesteal effect
-                                if (hasLifestealBuff) {
-                                    sub.health += 10;
-                                    if (sub.health > sub.maxHealth) {
-                                        sub.health = sub.maxHealth;
-                                    }
-                                }
-                                
-                                continue; 
-                            }
-                        }
-                    }
-                }
-            }
+    // Update the water offset for scrolling
+    game->waterOffset += game->waterScrollSpeed * deltaTime;
+    if (game->waterOffset >= game->waterTexture.height) {
+        game->waterOffset = 0; // Reset the offset to create a loop
+    }
 
-            // Update enemy bullets
-            for (int i = 0; i < config.maxEnemyBullets; i++) {
-                if (enemyBullets[i].active) {
-                    enemyBullets[i].rect.y += 5;  
-                    
-                    // Check if bullet is off screen
-                    if (enemyBullets[i].rect.y > config.screenHeight) {
-                        enemyBullets[i].active = false;
-                    }
-                    
-                    // Check collision with player
-                    if (CheckCollisionRecs(enemyBullets[i].rect, sub.hitbox)) {
-                        sub.health -= 10; 
-                        enemyBullets[i].active = false;
-                    }
-                }
-            }
+    // Update scroll position for game background
+    game->backgroundScrollX += game->scrollSpeed;
+    if (game->backgroundScrollX >= game->backgroundMenuTexture2.width - config->screenWidth) {
+        game->backgroundScrollX = 0;
+    }
 
-            bool allDefeated = true;
-            for (int i = 0; i < maxEnemies; i++) {
-                if (enemies[i].active) {
-                    allDefeated = false;
-                    break;
-                }
-            }
+    // Update wave time
+    config->waveTime += deltaTime * config->waveSpeed;
 
-            // Only proceed to next wave if all enemies are defeated
-            if (allDefeated) {
-                if (wave == 2) {  // First buff selection after wave 2
-                    currentState = STATE_BUFF_SELECTION;
-                } else if (wave == 4) {  // Second buff selection before boss (wave 5)
-                    currentState = STATE_BUFF_SELECTION_2;  // New state for second buff selection
-                } else if (wave < config.maxWaves) {
-                    wave++;
-                    maxEnemies = (wave == 5) ? 1 : wave * 5;  
-                    sub.speed += 1;
-                    ResetEnemies(enemies, maxEnemies, wave, &config);
-                }
-            }
+    // Latch every frame so a press between two ticks still reaches the next one
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        game->pendingInputs[p] = MergeInput(game->pendingInputs[p], GetPlayerInput(&game->inputMaps[p]));
+    }
 
-            // Game over condition
-            if (sub.health <= 0) {
-                gameOver = true;
-            }
+    // Run as many fixed ticks as the frame time covers; the simulation never sees deltaTime.
+    // Frame times jitter around the tick length, so a frame just short of a tick still runs
+    // it and pays the difference back later, keeping input to photon at one frame.
+    int wave = game->run.wave;
+    game->tickAccumulator += deltaTime;
+    if (game->tickAccumulator > SIM_TICK * MAX_TICKS_PER_FRAME) {
+        game->tickAccumulator = SIM_TICK * MAX_TICKS_PER_FRAME;
+    }
+    while (game->tickAccumulator >= SIM_TICK - TICK_SNAP) {
+        game->tickAccumulator -= SIM_TICK;
+        AdvanceRollback(game->rollback, game->pendingInputs);
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            game->pendingInputs[p].buttons &= INPUT_BOOST;
+        }
+    }
 
-            // Update animation frame
-            sub.frameTime += GetFrameTime();
-            if (sub.frameTime >= config.frameSpeed) {
-                sub.frameTime = 0.0f;
-                sub.currentFrame++;
-                if (sub.currentFrame >= config.frameCount) sub.currentFrame = 0;
-            }
+    // A wave that started inside the simulation is checkpointed for retries
+    if (game->run.wave != wave) {
+        EnterLevel(game, NULL);
+        SaveGame(game, &game->checkpoint);
+    }
 
-            // Draw submarine
-            if (!gameOver && !victory) {  
-                DrawTexturePro(submarineSheet,
-                    (Rectangle){
-                        0,                                     
-                        0,                                     
-                        sub.facingLeft ? -submarineSheet.width : submarineSheet.width,  
-                        submarineSheet.height                 
-                    },
-                    (Rectangle){
-                        sub.rect.x,
-                        sub.rect.y,
-                        sub.rect.width,
-                        sub.rect.height
-                    },
-                    (Vector2){ 0, 0 },
-                    0.0f,
-                    WHITE);
-            }
+    // The director learns what each live enemy and bullet costs from the measured frame time
+    int enemyCount = CountEntities(world, HAS_HEALTH | HAS_ENEMY, 0);
+    ObserveFrameLoad(&game->director, enemyCount, game->enemyBullets.count, game->canvas.frameLoad);
+    ObserveQualityLoad(&game->quality, game->canvas.frameLoad);
+
+    if (game->run.bossDefeated) {
+        ResetStates(&game->states, STATE_VICTORY);
+    } else if (CountLivePlayers(world) == 0) {
+        // Game over condition
+        ResetStates(&game->states, STATE_GAME_OVER);
+    } else if (enemyCount == 0) {
+        if (game->run.endless) {
+            // Endless waves are planned between ticks, from how the last one went
+            game->run.wave++;
+            StartWave(game);
+        } else if (game->run.wave == 2) {  // First buff selection after wave 2
+            PushState(&game->states, STATE_BUFF_SELECTION);
+        } else if (game->run.wave == 4) {  // Second buff selection before boss (wave 5)
+            PushState(&game->states, STATE_BUFF_SELECTION_2);
+        }
+    }
+}
 
-            // Draw bullets
-            for (int i = 0; i < 10; i++) {
-                if (bullets[i].active) {
-                    if (bullets[i].rect.width > 5) {  
-                        DrawTexturePro(rocketTexture1,
-                            (Rectangle){ 0, 0, rocketTexture1.width, rocketTexture1.height },
-                            (Rectangle){ 
-                                bullets[i].rect.x, 
-                                bullets[i].rect.y,
-                                bullets[i].rect.width * 0.5f,    
-                                bullets[i].rect.height * 0.5f    
-                            },
-                            (Vector2){ 0, 0 },
-                            270.0f,   
-                            WHITE);
-                    } else {
-                        // Normal bullet
-                        DrawRectangleRec(bullets[i].rect, RED);
-                    }
-                }
-            }
+void DrawPlaying(void *context) {
+    Game *game = context;
+    const GameConfig *config = &game->config;
+    const QualitySettings *quality = GetQualitySettings(game->quality.tier);
+    Texture2D waterTexture = game->waterTexture;
+    float waterOffset = game->waterOffset;
+
+    // Draw the moving water background; lower tiers skip it and show only the flat colour
+    if (quality->waterLayer) {
+        DrawTexturePro(waterTexture,
+            (Rectangle){ 0, waterOffset, waterTexture.width, waterTexture.height - waterOffset }, // Top part
+            (Rectangle){ 0, 0, config->screenWidth, config->screenHeight }, // Destination rectangle
+            (Vector2){ 0, 0 }, // Origin
+            0.0f, // Rotation
+            WHITE); // Color
+
+        DrawTexturePro(waterTexture,
+            (Rectangle){ 0, 0, waterTexture.width, waterOffset }, // Bottom part
+            (Rectangle){ 0, config->screenHeight - waterOffset, config->screenWidth, waterOffset }, // Destination rectangle
+            (Vector2){ 0, 0 }, // Origin
+            0.0f, // Rotation
+            WHITE); // Color
+    }
 
-            // Draw enemies
-            for (int i = 0; i < maxEnemies; i++) {
-                if (enemies[i].active) {
-                    Texture2D currentTexture;
-                    
-                    // Select texture based on movement direction and distance
-                    if (enemies[i].isBoss || enemies[i].isShooter) {
-                        // Use only front textures for boss and shooter enemies
-                        if (enemies[i].distanceMoved < 10) {
-                            currentTexture = normalEnemyFront;
-                        } else if (enemies[i].distanceMoved < 20) {
-                            currentTexture = normalEnemy2Front;
-                        } else {
-                            currentTexture = normalEnemy3Front;
-                        }
-                    } else {
-                        // Use both front and back textures for normal enemies
-                        if (enemies[i].moveDirection > 0) {  // Moving down
-                            if (enemies[i].distanceMoved < 10) {
-                                currentTexture = normalEnemyFront;
-                            } else if (enemies[i].distanceMoved < 20) {
-                                currentTexture = normalEnemy2Front;
-                            } else {
-                                currentTexture = normalEnemy3Front;
-                            }
-                        } else {  // Moving up
-                            if (enemies[i].distanceMoved < 10) {
-                                currentTexture = normalEnemyBack;
-                            } else if (enemies[i].distanceMoved < 20) {
-                                currentTexture = normalEnemy2Back;
-                            } else {
-                                currentTexture = normalEnemy3Back;
-                            }
-                        }
-                    }
-
-                    // Reset distance after completing animation cycle
-                    if (enemies[i].distanceMoved >= 30) {
-                        enemies[i].distanceMoved = 0;
-                    }
-
-                    DrawTexturePro(
-                        currentTexture,
-                        (Rectangle){ 
-                            0, 
-                            0, 
-                            currentTexture.width,
-                            currentTexture.height 
-                        },
-                        enemies[i].rect,
-                        (Vector2){ 0, 0 },
-                        0.0f,
-                        WHITE
-                    );
-
-                    // Update distance moved
-                    enemies[i].distanceMoved += fabsf(enemies[i].speed * enemies[i].moveDirection);
-
-                    // Draw health bar for boss
-                    if (enemies[i].isBoss) {
-                        float healthBarWidth = 20;
-                        float healthBarHeight = 20;
-                        float healthBarX = enemies[i].rect.x + (enemies[i].rect.width - healthBarWidth) / 2;
-                        float healthBarY = enemies[i].rect.y - healthBarHeight - 5;
-
-                        DrawRectangle(healthBarX, healthBarY, healthBarWidth, healthBarHeight, DARKGRAY);
-                        DrawRectangle(healthBarX, healthBarY, healthBarWidth * (enemies[i].health / enemies[i].maxHealth), healthBarHeight, GREEN);
-                    }
-                }
-            }
+    // Background colour, tinting the water where it is drawn
+    Color waterColor = { 0, 105, 148, quality->waterLayer ? WATER_TINT_ALPHA : 255 };
+    DrawRectangle(0, 0, config->screenWidth, config->screenHeight, waterColor);
+
+    // Draw submarines, enemies and all bullets; sprites go through the draw list,
+    // which culls them to the playfield and sorts them by layer and texture
+    BeginDrawList(&game->drawList, (Rectangle){ 0, 0, config->screenWidth, config->screenHeight }, &game->frameArena);
+    if (game->run.cavern.active) {
+        const CavernState *cavern = &game->run.cavern;
+        StreamTileMap(game->cavern, cavern->seed, cavern->rows, cavern->top);
+        DrawTileMap(game->cavern, cavern->top, &game->drawList);
+    }
+    game->atlas.submarine = game->submarineDetail[game->quality.tier];
+    RenderSystem(game->world, &game->atlas, &game->drawList);
+    FlushDrawList(&game->drawList);
+    DrawBulletField(&game->enemyBullets);
+    DrawEffects(&game->effects);
+
+    // HUD bars and counters are re-rendered only when their values change
+    const Health *subHealth = GetComponent(game->world, game->run.players[0], COMPONENT_HEALTH);
+    const Player *subState = GetComponent(game->world, game->run.players[0], COMPONENT_PLAYER);
+    const Health *partnerHealth = NULL;
+    int rollbackTicks = -1;
+    if (game->run.playerCount > 1) {
+        partnerHealth = GetComponent(game->world, game->run.players[1], COMPONENT_HEALTH);
+        rollbackTicks = game->rollback->resimulatedTicks;
+    }
+    SyncHudView(&game->hudView, &game->hudLayer, subHealth, subState, partnerHealth, rollbackTicks, game->run.timer, game->run.wave, game->run.score);
+    AddCanvasOverlay(&game->canvas, &game->hudLayer);
 
-            // Draw health bar
-            DrawRectangle(10, 10, sub.health * 2, 20, GREEN);
-            DrawRectangleLines(10, 10, sub.maxHealth * 2, 20, BLACK);
-            DrawText(TextFormat("Health: %d", sub.health), 15, 10, 20, WHITE);
+    if (game->showDebug) {
+        DrawDebugOverlay(game);
+    }
+}
 
-            // Draw energy bar
-            DrawRectangle(10, 35, sub.energy * 2, 20, BLUE);  
-            DrawRectangleLines(10, 35, 200, 20, BLACK);  
-            DrawText(TextFormat("Energy", sub.energy), 15, 35, 20, WHITE);  
+// Frame cost, what the draw list saved and how close each arena has come to its ceiling
+void DrawDebugOverlay(Game *game) {
+    Arena *frame = &game->frameArena;
+    const Arena *arenas[2] = { &game->frameArena, &game->levelArena };
+    const char *arenaNames[2] = { "Frame", "Level" };
+    const DrawList *list = &game->drawList;
+    const Transform *subTransform = GetComponent(game->world, game->run.players[0], COMPONENT_TRANSFORM);
+    const Player *subState = GetComponent(game->world, game->run.players[0], COMPONENT_PLAYER);
+    const char *lines[11];
+    int lineCount = 0;
+
+    lines[lineCount++] = ArenaFormat(frame, "%d FPS, load %.1f / %.1f ms, resolution step %d, %s quality",
+        GetFPS(), game->canvas.frameLoad * 1000.0f, game->canvas.frameBudget * 1000.0f, game->canvas.level,
+        GetQualitySettings(game->quality.tier)->name);
+    lines[lineCount++] = ArenaFormat(frame, "Entities %d / %d, bullets %d / %d, %d spawns and %d flow points refused",
+        game->world->entityCount, game->world->capacity, game->enemyBullets.count, game->enemyBullets.capacity,
+        game->world->refusedSpawns, game->flow->refusedPoints);
+    lines[lineCount++] = ArenaFormat(frame, "Submarine speed %.1f at (%.0f, %.0f)",
+        subState->speed, subTransform->rect.x, subTransform->rect.y);
+    lines[lineCount++] = ArenaFormat(frame, "Sprites %d submitted, %d culled, %d repeats, %d textures, %d dropped",
+        list->submitted, list->culled, list->duplicates, list->textureSwitches, list->dropped);
+    for (int i = 0; i < 2; i++) {
+        lines[lineCount++] = ArenaFormat(frame, "%s arena %d KB, peak %d / %d KB, %d refused", arenaNames[i],
+            (int)(arenas[i]->used / 1024), (int)(arenas[i]->highWater / 1024), (int)(arenas[i]->size / 1024), arenas[i]->failures);
+    }
+    lines[lineCount++] = ArenaFormat(frame, "Events %d last tick, %d dropped", game->events.count, game->events.dropped);
+    lines[lineCount++] = game->levelSummary;
+    if (game->run.cavern.active) {
+        const TileMap *map = game->cavern;
+        lines[lineCount++] = ArenaFormat(frame, "Cavern row %d of %d, %d of %d chunks resident, %d streamed, %d released",
+            (int)(game->run.cavern.top / TILE_SIZE), map->rows, map->resident, map->slotCount, map->streamed, map->evicted);
+    }
 
-            // Draw the timer
-            DrawText(TextFormat("Time: %.1f", timer), config.screenWidth - 120, 70, 20, WHITE);
+    DrawRectangle(0, 100, game->config.screenWidth, lineCount * 16 + 8, Fade(BLACK, 0.6f));
+    for (int i = 0; i < lineCount; i++) {
+        DrawText(lines[i], 6, 104 + i * 16, 10, GREEN);
+    }
+}
 
-            // Wave and score
-            DrawText(TextFormat("Wave: %d/%d", wave, 5), config.screenWidth - 120, 10, 20, WHITE);
-            DrawText(TextFormat("Score: %d", score), config.screenWidth - 120, 40, 20, WHITE);
+// Picks one of a screen's offers, then moves on to the next wave
+static void UpdateBuffScreen(Game *game, int state, const BuffScreen *screen) {
+    const GameConfig *config = &game->config;
+    UiContext *ui = game->ui;
+    int picked = -1;
+
+    UiBegin(ui, state);
+    UiLabel(ui, screen->title, config->screenWidth / 2 - screen->titleOffset, config->screenHeight / 2 - 50, 30, GRAY);
+    for (int i = 0; i < BUFF_SCREEN_OFFERS; i++) {
+        const BuffOffer *offer = &screen->offers[i];
+        Rectangle button = { config->screenWidth / 2 - 100, config->screenHeight / 2 + 70 * i, 200, 50 };
+        if (UiButton(ui, button, offer->label, offer->fontSize)) picked = i;
+    }
+    UiEnd(ui);
+    if (picked < 0) return;
+
+    // Buffs apply to both submarines
+    AddRunBuff(&game->run, game->world, screen->offers[picked].buff, config);
+    game->run.wave++;
+    game->run.maxEnemies = game->run.wave * 5;
+    StartWave(game);
+    PopState(&game->states);
+}
 
-            // Enemy bullets
-            for (int i = 0; i < config.maxEnemyBullets; i++) {
-                if (enemyBullets[i].active) {
-                    DrawRectangleRec(enemyBullets[i].rect, ORANGE); 
-                }
-            }
+void UpdateBuffSelection(void *context, float deltaTime) {
+    UpdateBuffScreen(context, STATE_BUFF_SELECTION, &buffScreens[0]);
+}
 
-            printf("Submarine Speed: %f, Position: (%f, %f)\n", sub.speed, sub.rect.x, sub.rect.y);
-
-            EndDrawing();
-        } else if (currentState == STATE_BUFF_SELECTION) {
-            BeginDrawing();
-            DrawTexturePro(backgroundMenuTexture2, 
-                (Rectangle){ 
-                    backgroundScrollX, 
-                    0, 
-                    config.screenWidth, 
-                    backgroundMenuTexture2.height 
-                },
-                (Rectangle){ 
-                    0, 
-                    0, 
-                    config.screenWidth, 
-                    config.screenHeight 
-                },
-                (Vector2){ 0, 0 },
-                0.0f,
-                WHITE);
-
-            DrawText("Choose Your Buff:", config.screenWidth / 2 - 100, config.screenHeight / 2 - 50, 30, GRAY);
-
-            // Define button rectangles for buffs
-            Rectangle lifestealButton = { config.screenWidth / 2 - 100, config.screenHeight / 2, 200, 50 };
-            Rectangle unlimitedRightClickButton = { config.screenWidth / 2 - 100, config.screenHeight / 2 + 70, 200, 50 };
-
-            // Check for mouse position
-            Vector2 mousePos = GetMousePosition();
-
-            // Draw Lifesteal button with hover effect
-            if (CheckCollisionPointRec(mousePos, lifestealButton)) {
-                DrawTexture(menuButtonPressedTexture, lifestealButton.x, lifestealButton.y, WHITE);
-            } else {
-                DrawTexture(menuButtonTexture, lifestealButton.x, lifestealButton.y, WHITE);
-            }
-            DrawText("Lifesteal (+10 HP/Kill)", lifestealButton.x + 20, lifestealButton.y + 10, 13, WHITE);
+void UpdatePreBossBuffSelection(void *context, float deltaTime) {
+    UpdateBuffScreen(context, STATE_BUFF_SELECTION_2, &buffScreens[1]);
+}
 
-            // Draw Unlimited Right Click button with hover effect
-            if (CheckCollisionPointRec(mousePos, unlimitedRightClickButton)) {
-                DrawTexture(menuButtonPressedTexture, unlimitedRightClickButton.x, unlimitedRightClickButton.y, WHITE);
-            } else {
-                DrawTexture(menuButtonTexture, unlimitedRightClickButton.x, unlimitedRightClickButton.y, WHITE);
-            }
-            DrawText("Unlimited Special Attack", unlimitedRightClickButton.x + 20, unlimitedRightClickButton.y + 10, 13, WHITE);
-
-            EndDrawing();
-
-            // Handle buff selection input
-            if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                if (CheckCollisionPointRec(mousePos, lifestealButton)) {
-                    hasLifestealBuff = true;
-                    wave++;
-                    maxEnemies = wave * 5;
-                    ResetEnemies(enemies, maxEnemies, wave, &config);
-                    currentState = STATE_PLAYING;
-                } else if (CheckCollisionPointRec(mousePos, unlimitedRightClickButton)) {
-                    hasUnlimitedRightClickBuff = true;
-                    wave++;
-                    maxEnemies = wave * 5;
-                    ResetEnemies(enemies, maxEnemies, wave, &config);
-                    currentState = STATE_PLAYING;
-                }
-            }
-        } else if (currentState == STATE_BUFF_SELECTION_2) {
-            BeginDrawing();
-            DrawTexturePro(backgroundMenuTexture2,  
-                (Rectangle){ 
-                    backgroundScrollX, 
-                    0, 
-                    config.screenWidth, 
-                    backgroundMenuTexture2.height 
-                },
-                (Rectangle){ 
-                    0, 
-                    0, 
-                    config.screenWidth, 
-                    config.screenHeight 
-                },
-                (Vector2){ 0, 0 },
-                0.0f,
-                WHITE);
-
-            DrawText("Choose Your Pre-Boss Buff:", config.screenWidth / 2 - 150, config.screenHeight / 2 - 50, 30, GRAY);
-
-            // Define button rectangles for buffs
-            Rectangle unlimitedEnergyButton = { config.screenWidth / 2 - 100, config.screenHeight / 2, 200, 50 };
-            Rectangle fullHealthButton = { config.screenWidth / 2 - 100, config.screenHeight / 2 + 70, 200, 50 };
-
-            // Check for mouse position
-            Vector2 mousePos = GetMousePosition();
-
-            // Draw Unlimited Energy button with hover effect
-            if (CheckCollisionPointRec(mousePos, unlimitedEnergyButton)) {
-                DrawTexture(menuButtonPressedTexture, unlimitedEnergyButton.x, unlimitedEnergyButton.y, WHITE);
-            } else {
-                DrawTexture(menuButtonTexture, unlimitedEnergyButton.x, unlimitedEnergyButton.y, WHITE);
-            }
-            DrawText("Unlimited Energy", unlimitedEnergyButton.x + 20, unlimitedEnergyButton.y + 10, 18, WHITE);
+void DrawBuffSelection(void *context) {
+    Game *game = context;
+    DrawScrollingBackground(game, game->backgroundMenuTexture2, game->backgroundScrollX);
+    AddCanvasOverlay(&game->canvas, &game->ui->layer);
+}
 
-            // Draw Full Health button with hover effect
-            if (CheckCollisionPointRec(mousePos, fullHealthButton)) {
-                DrawTexture(menuButtonPressedTexture, fullHealthButton.x, fullHealthButton.y, WHITE);
-            } else {
-                DrawTexture(menuButtonTexture, fullHealthButton.x, fullHealthButton.y, WHITE);
-            }
-            DrawText("Full Health Restore", fullHealthButton.x + 20, fullHealthButton.y + 10, 18, WHITE);
-
-            EndDrawing();
-
-            // Handle buff selection input
-            if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                if (CheckCollisionPointRec(mousePos, unlimitedEnergyButton)) {
-                    sub.energy = 100.0f;  // Set energy to max
-                    hasUnlimitedEnergyBuff = true;  // Add this variable at the top with other buff variables
-                    wave++;
-                    maxEnemies = wave * 5;
-                    ResetEnemies(enemies, maxEnemies, wave, &config);
-                    currentState = STATE_PLAYING;
-                } else if (CheckCollisionPointRec(mousePos, fullHealthButton)) {
-                    sub.health = sub.maxHealth;  // Restore full health
-                    wave++;
-                    maxEnemies = wave * 5;
-                    ResetEnemies(enemies, maxEnemies, wave, &config);
-                    currentState = STATE_PLAYING;
-                }
-            }
-        } else if (currentState == STATE_OPTIONS) {
-            BeginDrawing();
-            
-            // Update scroll position for options background
-            optionsScrollX += optionsScrollSpeed;
-            if (optionsScrollX >= backgroundMenuTexture.width) {
-                optionsScrollX = 0;  
-            }
+// The run's time is recorded once, when the boss goes down, unless it was resumed from a checkpoint
+void EnterVictory(void *context) {
+    Game *game = context;
+    float *lowestTime = &game->lowestTimes[game->run.difficultyLevel - 1];
 
-            // Draw the scrolling background
-            DrawTexturePro(backgroundMenuTexture,
-                (Rectangle){ optionsScrollX, 0, config.screenWidth, backgroundMenuTexture.height },
-                (Rectangle){ 0, 0, config.screenWidth, config.screenHeight },
-                (Vector2){ 0, 0 },
-                0.0f,
-                WHITE);
-
-            // Draw the settings title
-            DrawText("Settings", config.screenWidth / 2 - 50, 50, 30, WHITE);
-
-            DrawText("Controls", 100, 100, 20, WHITE);
-            DrawText("Move Left: A", 100, 130, 20, WHITE);
-            DrawText("Move Right: D", 100, 150, 20, WHITE);
-            DrawText("Use Speed Boost: Shift + A / D", 100, 170, 20, WHITE);
-            DrawText("Shoot: Left Mouse Button", 100, 190, 20, WHITE);
-            DrawText("Use Special Attack: Right Mouse Button", 100, 210, 20, WHITE);
-            DrawText("Exit Game: Esc", 100, 230, 20, WHITE);    
-
-            // Volume Slider
-            DrawText("Music Volume:", 100, 270, 20, WHITE);
-            Rectangle volumeSlider = { 100, 300, 200, 20 }; 
-            DrawRectangleRec(volumeSlider, DARKGRAY);  
-
-            //current volume level
-            Rectangle volumeBar = { 100, 300, 200 * musicVolume, 20 };  
-            DrawRectangleRec(volumeBar, GREEN);  
-
-            // check mouse position on the current volume
-            Vector2 mousePos = GetMousePosition();
-            if (IsMouseButtonDown(MOUSE_LEFT_BUTTON) && CheckCollisionPointRec(mousePos, volumeSlider)) {
-                musicVolume = (mousePos.x - volumeSlider.x) / volumeSlider.width;  
-                if (musicVolume < 0) musicVolume = 0;  
-                if (musicVolume > 1) musicVolume = 1;  
-                SetMusicVolume(backgroundMusic, musicVolume);  
-            }
+    if (!game->run.practice && game->run.timer < *lowestTime) {
+        *lowestTime = game->run.timer;
+        WriteLowestTimes(game->lowestTimes, 3);  // Write the new times to file
+    }
+}
 
-            // Draw the back button
-            Rectangle backButton = {10, 10, 60, 55};  
-            if (CheckCollisionPointRec(mousePos, backButton)) {
-                DrawTexture(backButtonPressedTexture, backButton.x, backButton.y, WHITE); 
-            } else {
-                DrawTexture(backButtonTexture, backButton.x, backButton.y, WHITE); 
-            }
+void UpdateVictory(void *context, float deltaTime) {
+    Game *game = context;
 
-            DrawText("←", backButton.x + backButton.width / 2 - 10, backButton.y + backButton.height / 2 - 10, 20, WHITE); 
+    if (IsKeyPressed(KEY_ENTER)) {
+        // Reset all game variables
+        ResetGame(game);
+        ResetStates(&game->states, STATE_LEVEL_SELECTION);
+    }
+}
 
-            // Check for button clicks to Exit
-            if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && CheckCollisionPointRec(mousePos, backButton)) {
-                currentState = STATE_MENU; 
-            }
+void DrawVictory(void *context) {
+    Game *game = context;
+    const GameConfig *config = &game->config;
+    TextSystem *text = game->text;
 
-            EndDrawing();
-        } else if (currentState == STATE_VICTORY) {
-            BeginDrawing();
-            // Change the background to match the game over background
-            DrawTexturePro(backgroundMenuTexture,  // Use the same texture as the game over screen
-                (Rectangle){ 
-                    backgroundScrollX, 
-                    0, 
-                    config.screenWidth, 
-                    backgroundMenuTexture.height 
-                },
-                (Rectangle){ 
-                    0, 
-                    0, 
-                    config.screenWidth, 
-                    config.screenHeight 
-                },
-                (Vector2){ 0, 0 },
-                0.0f,
-                WHITE);
-            
-            // Display victory text and time
-            DrawText("Victory!", config.screenWidth / 2 - 100, config.screenHeight / 2 - 50, 40, WHITE);
-            DrawText(TextFormat("Time: %.1f", timer), config.screenWidth / 2 - 80, config.screenHeight / 2, 20, WHITE);
-            DrawText("Press Enter to restart or Esc to exit", config.screenWidth / 2 - 200, config.screenHeight / 2 + 30, 20, BLACK);
-            
-            EndDrawing();
-
-            if (IsKeyPressed(KEY_ENTER)) {
-                // Write the times to file before resetting
-                WriteLowestTimes(lowestTimes, 3);
-                
-                // Reset all game variables
-                timer = 0.0f;
-                wave = 1;
-                maxEnemies = wave * 5;
-                sub.speed = 200;
-                sub.health = sub.maxHealth;
-                sub.energy = 100.0f;
-                ResetEnemies(enemies, maxEnemies, wave, &config);
-                victory = false;
-                gameOver = false; 
-                currentState = STATE_LEVEL_SELECTION;
-            } else if (IsKeyPressed(KEY_ESCAPE)) {
-                CloseWindow(); // Exit the game
-            }
-        }
-    }
+    DrawScrollingBackground(game, game->backgroundMenuTexture, game->backgroundScrollX);
 
-    UnloadTexture(submarineSheet);
-    UnloadTexture(rocketTexture1);
-    UnloadTexture(startMenuTexture);
-    UnloadTexture(backgroundMenuTexture);
-    UnloadTexture(backgroundMenuTexture2);
-    UnloadTexture(normalEnemyFront);
-    UnloadTexture(normalEnemyBack);
-    UnloadTexture(normalEnemy2Front);
-    UnloadTexture(normalEnemy3Front);
-    UnloadTexture(normalEnemy2Back);
-    UnloadTexture(normalEnemy3Back);
-    UnloadTexture(bossTexture);
-    UnloadTexture(leftClickAnimationTexture);
-    UnloadFont(config.customFont);
-    UnloadTexture(waterTexture);
-    CloseWindow();
-    return 0;
-}
+    DrawCachedText(text, game->bannerFace, "VICTORY!", (Vector2){ config->screenWidth / 2 - 120, config->screenHeight / 2 - 100 }, GREEN);
+    DrawCachedText(text, game->headingFace, "You completed all 5 waves!", (Vector2){ config->screenWidth / 2 - 190, config->screenHeight / 2 }, BLACK);
 
+    // Display the run's time
+    Vector2 timePos = { config->screenWidth / 2 - 80, config->screenHeight / 2 + 30 };
+    timePos.x += DrawCachedText(text, game->bodyFace, "Time: ", timePos, BLACK);
+    DrawTextNumber(text, game->bodyFace, (int)(game->run.timer * 10.0f + 0.5f), 1, timePos, BLACK);
 
-void ResetEnemies(Enemy enemies[], int enemyCount, int wave, const GameConfig* config) {
-    if (wave == 5) {
-        enemies[0].rect.x = config->screenWidth / 2 - 100;
-        enemies[0].rect.y = 50;
-        enemies[0].rect.width = 200;
-        enemies[0].rect.height = 200;
-        enemies[0].speed = 2;
-        enemies[0].maxHealth = 50;
-        enemies[0].health = enemies[0].maxHealth;
-        enemies[0].active = true;
-        enemies[0].isBoss = true;
-        enemies[0].shootTimer = 0;
-        enemies[0].spawnTimer = 0;
-        enemies[0].moveDirection = 1;  
-        enemies[0].isShooter = false;  
-
-
-        for (int i = 1; i < config->maxEnemies; i++) {
-            enemies[i].active = false;
-            enemies[i].isBoss = false;
-        }
-        return;
+    DrawCachedText(text, game->bodyFace, "Press Enter to restart or Esc to exit", (Vector2){ config->screenWidth / 2 - 200, config->screenHeight / 2 + 60 }, BLACK);
+}
+
+void UpdateGameOver(void *context, float deltaTime) {
+    Game *game = context;
+
+    if (IsKeyPressed(KEY_ENTER)) {
+        // Reset game variables and state
+        ResetGame(game);
+        ResetStates(&game->states, STATE_LEVEL_SELECTION);
+    } else if (IsKeyPressed(KEY_R) && RestoreGame(game, &game->checkpoint)) {
+        // Retry the wave exactly as it started
+        game->run.practice = true;
+        ResetStates(&game->states, STATE_PLAYING);
     }
+}
 
+void DrawGameOver(void *context) {
+    Game *game = context;
+    const GameConfig *config = &game->config;
 
-    for (int i = 0; i < enemyCount && i < config->maxEnemies; i++) {
-        enemies[i].rect.x = GetRandomValue(0, config->screenWidth - 40);
-        enemies[i].rect.y = GetRandomValue(50, config->screenHeight/2);  
-        enemies[i].rect.width = 64;   
-        enemies[i].rect.height = 64;  
-        enemies[i].speed = 2;
-        enemies[i].maxHealth = wave;
-        enemies[i].health = enemies[i].maxHealth;
-        enemies[i].active = true;
-        enemies[i].isBoss = false;
-        enemies[i].moveDirection = 1;  
-        
-
-        if (wave >= 3 && GetRandomValue(0, 4) == 0) {
-            enemies[i].isShooter = true;
-            enemies[i].shootTimer = 0;
-            enemies[i].moveDirection = GetRandomValue(0, 1) * 2 - 1;  
-        } else {
-            enemies[i].isShooter = false;
-        }
-        enemies[i].distanceMoved = 0;
+    DrawScrollingBackground(game, game->backgroundMenuTexture, game->backgroundScrollX);
+
+    DrawCachedText(game->text, game->bannerFace, "Game Over!", (Vector2){ config->screenWidth / 2 - 100, config->screenHeight / 2 - 50 }, RED);
+    DrawCachedText(game->text, game->bodyFace, "Press Enter to restart or Esc to exit", (Vector2){ config->screenWidth / 2 - 200, config->screenHeight / 2 }, BLACK);
+    DrawCachedText(game->text, game->bodyFace, "Press R to retry the wave", (Vector2){ config->screenWidth / 2 - 130, config->screenHeight / 2 + 30 }, BLACK);
+
+    if (game->run.endless) {
+        Vector2 wavePos = { config->screenWidth / 2 - 80, config->screenHeight / 2 + 60 };
+        wavePos.x += DrawCachedText(game->text, game->bodyFace, "Reached wave ", wavePos, BLACK);
+        DrawTextNumber(game->text, game->bodyFace, game->run.wave, 0, wavePos, BLACK);
     }
+}
 
-    printf("Wave %d: Spawned %d enemies\n", wave, enemyCount);
+// Nothing below the pause menu is simulated or redrawn while it is open
+void UpdatePaused(void *context, float deltaTime) {
+    Game *game = context;
+    const GameConfig *config = &game->config;
+    UiContext *ui = game->ui;
+
+    Rectangle resumeButton = { config->screenWidth / 2 - 100, config->screenHeight / 2, 200, 50 };
+    Rectangle optionsButton = { config->screenWidth / 2 - 100, config->screenHeight / 2 + 70, 200, 50 };
+    Rectangle retryButton = { config->screenWidth / 2 - 100, config->screenHeight / 2 + 140, 200, 50 };
+    Rectangle quitButton = { config->screenWidth / 2 - 100, config->screenHeight / 2 + 210, 200, 50 };
+
+    UiBegin(ui, STATE_PAUSED);
+    UiLabelEx(ui, game->bannerFace, "PAUSED", (Vector2){ config->screenWidth / 2 - 80, config->screenHeight / 2 - 80 }, WHITE);
+    bool resume = UiButton(ui, resumeButton, "Resume", 20);
+    bool settings = UiButton(ui, optionsButton, "Settings", 20);
+    bool retry = UiButton(ui, retryButton, "Retry Wave", 20);
+    bool quit = UiButton(ui, quitButton, "Quit to Menu", 20);
+    UiEnd(ui);
+
+    if (resume || IsActionPressed(&game->inputMaps[0], ACTION_PAUSE) || IsActionPressed(&game->inputMaps[1], ACTION_PAUSE)) {
+        PopState(&game->states);
+    } else if (settings) {
+        PushState(&game->states, STATE_OPTIONS);
+    } else if (retry && RestoreGame(game, &game->checkpoint)) {
+        game->run.practice = true;
+        PopState(&game->states);
+    } else if (quit) {
+        ResetGame(game);
+        ResetStates(&game->states, STATE_MENU);
+    }
 }
 
-bool CheckBossWaveComplete(Enemy enemies[], const GameConfig* config) {
-    if (enemies[0].active) return false;
-    
-    for (int i = 1; i < config->maxEnemies; i++) {
-        if (enemies[i].active) return false;
+// Overlay states only add the UI layer; the frozen scene under them is presented again
+void DrawUiOverlay(void *context) {
+    Game *game = context;
+    AddCanvasOverlay(&game->canvas, &game->ui->layer);
+}
+
+HudView InitHudView(const GameConfig *config, TextSystem *text) {
+    return (HudView){
+        // Impossible values so the first sync redraws every field
+        .health = -1, .maxHealth = -1, .energyWidth = -1, .timeTenths = -1,
+        .wave = -1, .maxWaves = config->maxWaves, .score = -1,
+        .partnerHealth = -2, .rollbackTicks = -2,
+        .healthRegion = { 0, 5, 260, 28 },
+        .partnerRegion = { 0, 58, 260, 25 },
+        .rollbackRegion = { 0, config->screenHeight - 30, 260, 28 },
+        .energyRegion = { 0, 33, 260, 25 },
+        .waveRegion = { config->screenWidth - 120, 5, 120, 28 },
+        .scoreRegion = { config->screenWidth - 120, 35, 120, 28 },
+        .timeRegion = { config->screenWidth - 120, 65, 120, 28 },
+        .text = text,
+        .face = GetTextFace(text, false, 20, 2),
+    };
+}
+
+void SyncHudView(HudView *hud, UiLayer *layer, const Health *health, const Player *player, const Health *partner, int rollbackTicks, float timer, int wave, int score) {
+    int energyWidth = (int)(player->energy * 2);
+    int timeTenths = (int)(timer * 10.0f + 0.5f);
+    int partnerHealth = (partner != NULL) ? partner->current : -1;
+
+    if (health->current != hud->health || health->max != hud->maxHealth) {
+        hud->health = health->current;
+        hud->maxHealth = health->max;
+        InvalidateUiRegion(layer, hud->healthRegion);
+    }
+    if (energyWidth != hud->energyWidth) {
+        hud->energyWidth = energyWidth;
+        InvalidateUiRegion(layer, hud->energyRegion);
+    }
+    if (partnerHealth != hud->partnerHealth) {
+        hud->partnerHealth = partnerHealth;
+        InvalidateUiRegion(layer, hud->partnerRegion);
+    }
+    if (rollbackTicks != hud->rollbackTicks) {
+        hud->rollbackTicks = rollbackTicks;
+        InvalidateUiRegion(layer, hud->rollbackRegion);
+    }
+    if (timeTenths != hud->timeTenths) {
+        hud->timeTenths = timeTenths;
+        InvalidateUiRegion(layer, hud->timeRegion);
+    }
+    if (wave != hud->wave) {
+        hud->wave = wave;
+        InvalidateUiRegion(layer, hud->waveRegion);
+    }
+    if (score != hud->score) {
+        hud->score = score;
+        InvalidateUiRegion(layer, hud->scoreRegion);
     }
-    
-    return true;
 }
 
-bool CheckCollisionWithWalls(float newX, float subY, Rectangle subRect, const GameConfig* config) {
-    // Check for collision with walls using the passed parameters
-    if (newX < 0 || newX + subRect.width > config->screenWidth) {
-        return true; 
+void DrawHudLayer(void *context, Rectangle region) {
+    const HudView *hud = context;
+
+    // Draw health bar
+    if (CheckCollisionRecs(region, hud->healthRegion)) {
+        DrawRectangle(10, 10, hud->health * 2, 20, GREEN);
+        DrawRectangleLines(10, 10, hud->maxHealth * 2, 20, BLACK);
+        Vector2 pos = { 15, 10 };
+        pos.x += DrawCachedText(hud->text, hud->face, "Health: ", pos, WHITE);
+        DrawTextNumber(hud->text, hud->face, hud->health, 0, pos, WHITE);
+    }
+
+    // Draw energy bar
+    if (CheckCollisionRecs(region, hud->energyRegion)) {
+        DrawRectangle(10, 35, hud->energyWidth, 20, BLUE);
+        DrawRectangleLines(10, 35, 200, 20, BLACK);
+        DrawCachedText(hud->text, hud->face, "Energy", (Vector2){ 15, 35 }, WHITE);
+    }
+
+    // Second submarine's health, and how far the last rollback had to rewind
+    if (hud->partnerHealth >= 0 && CheckCollisionRecs(region, hud->partnerRegion)) {
+        DrawRectangle(10, 60, hud->partnerHealth * 2, 20, SKYBLUE);
+        DrawRectangleLines(10, 60, hud->maxHealth * 2, 20, BLACK);
+        Vector2 pos = { 15, 60 };
+        pos.x += DrawCachedText(hud->text, hud->face, "P2: ", pos, WHITE);
+        DrawTextNumber(hud->text, hud->face, hud->partnerHealth, 0, pos, WHITE);
+    }
+    if (hud->rollbackTicks >= 0 && CheckCollisionRecs(region, hud->rollbackRegion)) {
+        Vector2 pos = { 10, hud->rollbackRegion.y + 5 };
+        pos.x += DrawCachedText(hud->text, hud->face, "Rollback: ", pos, WHITE);
+        pos.x += DrawTextNumber(hud->text, hud->face, hud->rollbackTicks, 0, pos, WHITE);
+        DrawCachedText(hud->text, hud->face, " ticks", pos, WHITE);
     }
-    return false; 
-}
\ No newline at end of file
+
+    // Wave, score and timer: static captions from the layout cache, numbers from the digit strip
+    if (CheckCollisionRecs(region, hud->waveRegion)) {
+        Vector2 pos = { hud->waveRegion.x, 10 };
+        pos.x += DrawCachedText(hud->text, hud->face, "Wave: ", pos, WHITE);
+        pos.x += DrawTextNumber(hud->text, hud->face, hud->wave, 0, pos, WHITE);
+        // Endless mode has no last wave
+        if (hud->maxWaves > 0) {
+            pos.x += DrawCachedText(hud->text, hud->face, "/", pos, WHITE);
+            DrawTextNumber(hud->text, hud->face, hud->maxWaves, 0, pos, WHITE);
+        }
+    }
+    if (CheckCollisionRecs(region, hud->scoreRegion)) {
+        Vector2 pos = { hud->scoreRegion.x, 40 };
+        pos.x += DrawCachedText(hud->text, hud->face, "Score: ", pos, WHITE);
+        DrawTextNumber(hud->text, hud->face, hud->score, 0, pos, WHITE);
+    }
+    if (CheckCollisionRecs(region, hud->timeRegion)) {
+        Vector2 pos = { hud->timeRegion.x, 70 };
+        pos.x += DrawCachedText(hud->text, hud->face, "Time: ", pos, WHITE);
+        DrawTextNumber(hud->text, hud->face, hud->timeTenths, 1, pos, WHITE);
+    }
+}
@@ -0,0 +1,92 @@
+// mmap and posix_madvise are POSIX, not C99
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "mapfile.h"
+
+#ifdef _WIN32
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+bool MapFile(const char *fileName, MappedFile *file) {
+    *file = (MappedFile){ 0 };
+
+    // Sequential scan lets the cache manager read ahead in large chunks
+    HANDLE handle = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+        CloseHandle(handle);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        CloseHandle(handle);
+        return false;
+    }
+
+    const void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL) {
+        CloseHandle(mapping);
+        CloseHandle(handle);
+        return false;
+    }
+
+    file->data = data;
+    file->size = (size_t)size.QuadPart;
+    file->handle = handle;
+    file->mapping = mapping;
+    return true;
+}
+
+void UnmapFile(MappedFile *file) {
+    if (file->data == NULL) return;
+    UnmapViewOfFile(file->data);
+    CloseHandle(file->mapping);
+    CloseHandle(file->handle);
+    *file = (MappedFile){ 0 };
+}
+
+#else
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+bool MapFile(const char *fileName, MappedFile *file) {
+    *file = (MappedFile){ 0 };
+
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    // The mapping keeps the file referenced, so the descriptor can go straight away
+    void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+
+    // Every byte is about to be uploaded, so ask for read-ahead of the whole file
+    posix_madvise(data, (size_t)info.st_size, POSIX_MADV_WILLNEED);
+
+    file->data = data;
+    file->size = (size_t)info.st_size;
+    return true;
+}
+
+void UnmapFile(MappedFile *file) {
+    if (file->data == NULL) return;
+    munmap((void *)file->data, file->size);
+    *file = (MappedFile){ 0 };
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Read-only view of a whole file in memory. Pages are read on first touch,
+// so nothing is copied through a stdio buffer. Kept apart from raylib.h
+// because windows.h clashes with raylib's names.
+typedef struct MappedFile {
+    const unsigned char *data;
+    size_t size;
+    void *handle;
+    void *mapping;
+} MappedFile;
+
+bool MapFile(const char *fileName, MappedFile *file);
+void UnmapFile(MappedFile *file);
+
+#endif
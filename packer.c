@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "archive.h"
+
+// Build step: decodes every texture listed in a manifest and writes them into one archive
+// gcc packer.c -o packer.exe -I -L -lraylib -lopengl32 -lgdi32 -lwinmm
+// ./packer.exe assets.txt assets.pak
+
+#define MAX_PACKED_ASSETS 256
+
+typedef struct PackedAsset {
+    ArchiveEntry entry;
+    Image image;
+} PackedAsset;
+
+static int CompareAssets(const void *a, const void *b) {
+    return strncmp(((const PackedAsset *)a)->entry.name, ((const PackedAsset *)b)->entry.name, ARCHIVE_NAME_LENGTH);
+}
+
+static unsigned int AlignOffset(unsigned int offset) {
+    return (offset + ARCHIVE_ALIGNMENT - 1) / ARCHIVE_ALIGNMENT * ARCHIVE_ALIGNMENT;
+}
+
+// Reads the manifest: one path per line, blank lines and lines starting with '#' skipped
+static int ReadManifest(const char *fileName, PackedAsset *assets, int maxAssets) {
+    FILE *file = fopen(fileName, "r");
+    if (file == NULL) {
+        printf("Error opening manifest: %s\n", fileName);
+        return -1;
+    }
+
+    char line[256];
+    int count = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') continue;
+        if (strlen(line) >= ARCHIVE_NAME_LENGTH) {
+            printf("Skipping %s: path longer than %d characters\n", line, ARCHIVE_NAME_LENGTH - 1);
+            continue;
+        }
+        if (count == maxAssets) {
+            printf("Skipping %s: more than %d assets\n", line, maxAssets);
+            continue;
+        }
+
+        Image image = LoadImage(line);
+        if (image.data == NULL) {
+            printf("Skipping %s: could not be decoded\n", line);
+            continue;
+        }
+
+        PackedAsset *asset = &assets[count++];
+        memset(&asset->entry, 0, sizeof(ArchiveEntry));
+        strcpy(asset->entry.name, line);
+        asset->entry.size = (unsigned int)GetPixelDataSize(image.width, image.height, image.format);
+        asset->entry.width = image.width;
+        asset->entry.height = image.height;
+        asset->entry.format = image.format;
+        asset->entry.mipmaps = 1;
+        asset->image = image;
+    }
+    fclose(file);
+    return count;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        printf("Usage: %s <manifest> <archive>\n", argv[0]);
+        return 1;
+    }
+
+    static PackedAsset assets[MAX_PACKED_ASSETS];
+    int count = ReadManifest(argv[1], assets, MAX_PACKED_ASSETS);
+    if (count < 0) return 1;
+
+    // Sorted so the game can binary search the table; pixel data follows it, aligned
+    qsort(assets, count, sizeof(PackedAsset), CompareAssets);
+    unsigned int offset = AlignOffset(sizeof(ArchiveHeader) + count * sizeof(ArchiveEntry));
+    for (int i = 0; i < count; i++) {
+        assets[i].entry.offset = offset;
+        offset = AlignOffset(offset + assets[i].entry.size);
+    }
+
+    FILE *file = fopen(argv[2], "wb");
+    if (file == NULL) {
+        printf("Error opening archive: %s\n", argv[2]);
+        return 1;
+    }
+
+    ArchiveHeader header = { ARCHIVE_MAGIC, ARCHIVE_VERSION, (unsigned int)count, 0 };
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int i = 0; ok && i < count; i++) {
+        ok = fwrite(&assets[i].entry, sizeof(ArchiveEntry), 1, file) == 1;
+    }
+
+    static const char padding[ARCHIVE_ALIGNMENT] = { 0 };
+    for (int i = 0; ok && i < count; i++) {
+        long position = ftell(file);
+        ok = fwrite(padding, 1, assets[i].entry.offset - position, file) == assets[i].entry.offset - position &&
+             fwrite(assets[i].image.data, 1, assets[i].entry.size, file) == assets[i].entry.size;
+        UnloadImage(assets[i].image);
+    }
+
+    if (fclose(file) != 0 || !ok) {
+        printf("Error writing archive: %s\n", argv[2]);
+        return 1;
+    }
+    printf("Packed %d assets into %s\n", count, argv[2]);
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include "pattern.h"
+#include <stddef.h>
+#include <math.h>
+
+#define ANGLE_STEPS 256
+
+static const Color palette[] = { ORANGE, RED, MAGENTA, SKYBLUE, YELLOW, LIME };
+#define PALETTE_SIZE ((int)(sizeof(palette) / sizeof(palette[0])))
+
+static Vector2 directions[ANGLE_STEPS];
+static bool directionsReady = false;
+
+void InitPatterns(void) {
+    for (int i = 0; i < ANGLE_STEPS; i++) {
+        float angle = i * 2.0f * PI / ANGLE_STEPS;
+        directions[i] = (Vector2){ cosf(angle), sinf(angle) };
+    }
+    directionsReady = true;
+}
+
+static void Emit(Emitter *emitter, BulletField *field, Vector2 origin, unsigned char angle) {
+    Vector2 direction = directions[angle];
+    float speed = emitter->speed / 10.0f;
+    float size = emitter->size;
+    Rectangle rect = { origin.x - size / 2, origin.y - size / 2, size, size };
+
+    SpawnBullet(field, rect, (Vector2){ direction.x * speed, direction.y * speed },
+        palette[emitter->color % PALETTE_SIZE], emitter->damage);
+}
+
+Emitter CreateEmitter(const unsigned char *program, int damage) {
+    return (Emitter){
+        .program = program,
+        .heading = ANGLE_STEPS / 4,      // Straight down
+        .speed = 30,
+        .size = 8,
+        .damage = (unsigned char)damage,
+    };
+}
+
+void RunEmitter(Emitter *emitter, BulletField *field, Vector2 origin, Vector2 target) {
+    if (!directionsReady) InitPatterns();
+    if (emitter->program == NULL) return;
+
+    if (emitter->wait > 0) {
+        emitter->wait--;
+        return;
+    }
+
+    const unsigned char *code = emitter->program;
+    for (int step = 0; step < PATTERN_MAX_STEPS; step++) {
+        unsigned char op = code[emitter->pc++];
+
+        switch (op) {
+            case PATTERN_END:
+                emitter->pc--;
+                return;
+            case PATTERN_WAIT:
+                // A wait of n frames resumes on the n-th following frame
+                emitter->wait = code[emitter->pc++] - 1;
+                return;
+            case PATTERN_SPEED:
+                emitter->speed = code[emitter->pc++];
+                break;
+            case PATTERN_SIZE:
+                emitter->size = code[emitter->pc++];
+                break;
+            case PATTERN_COLOR:
+                emitter->color = code[emitter->pc++];
+                break;
+            case PATTERN_HEADING:
+                emitter->heading = code[emitter->pc++];
+                break;
+            case PATTERN_TURN:
+                emitter->heading += code[emitter->pc++];
+                break;
+            case PATTERN_AIM: {
+                float angle = atan2f(target.y - origin.y, target.x - origin.x);
+                emitter->heading = (unsigned char)(int)lroundf(angle * ANGLE_STEPS / (2.0f * PI));
+            } break;
+            case PATTERN_RADIAL: {
+                int count = code[emitter->pc++];
+                for (int i = 0; i < count; i++) {
+                    Emit(emitter, field, origin, (unsigned char)(emitter->heading + i * ANGLE_STEPS / count));
+                }
+            } break;
+            case PATTERN_FAN: {
+                int count = code[emitter->pc++];
+                int spread = code[emitter->pc++];
+                for (int i = 0; i < count; i++) {
+                    int offset = (count > 1) ? i * spread / (count - 1) - spread / 2 : 0;
+                    Emit(emitter, field, origin, (unsigned char)(emitter->heading + offset));
+                }
+            } break;
+            case PATTERN_REPEAT: {
+                int count = code[emitter->pc++];
+                if (emitter->depth == PATTERN_MAX_DEPTH) break;
+                emitter->loopStart[emitter->depth] = emitter->pc;
+                emitter->loopCount[emitter->depth] = count;
+                emitter->depth++;
+            } break;
+            case PATTERN_LOOP:
+                if (emitter->depth == 0) break;
+                if (--emitter->loopCount[emitter->depth - 1] > 0) {
+                    emitter->pc = emitter->loopStart[emitter->depth - 1];
+                } else {
+                    emitter->depth--;
+                }
+                break;
+            case PATTERN_JUMP:
+                emitter->pc = code[emitter->pc];
+                break;
+            default:
+                // Unknown opcode: stop rather than run operands as code
+                emitter->program = NULL;
+                return;
+        }
+    }
+}
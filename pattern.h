@@ -0,0 +1,50 @@
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include "raylib.h"
+#include "bullets.h"
+
+#define PATTERN_MAX_DEPTH 4      // Nested REPEAT blocks
+#define PATTERN_MAX_STEPS 256    // Instructions an emitter may run in one frame
+
+// Bullet patterns are byte programs: an opcode followed by its one-byte operands.
+// Angles are in 256ths of a turn so headings wrap for free.
+typedef enum PatternOp {
+    PATTERN_END,             // Stop emitting
+    PATTERN_WAIT,            // frames
+    PATTERN_SPEED,           // tenths of a pixel per frame
+    PATTERN_SIZE,            // pixels
+    PATTERN_COLOR,           // index into the pattern palette
+    PATTERN_HEADING,         // angle: set heading
+    PATTERN_TURN,            // angle: add to heading
+    PATTERN_AIM,             // Point heading at the target
+    PATTERN_RADIAL,          // count: evenly spaced ring starting at heading
+    PATTERN_FAN,             // count, spread angle: fan centred on heading
+    PATTERN_REPEAT,          // count: run the block up to the matching LOOP count times
+    PATTERN_LOOP,
+    PATTERN_JUMP             // offset: continue from this byte, for endless patterns
+} PatternOp;
+
+// Execution state of one program; plain data, it can sit in a component
+typedef struct Emitter {
+    const unsigned char *program;
+    int pc;
+    int wait;
+    unsigned char heading;
+    unsigned char speed;
+    unsigned char size;
+    unsigned char color;
+    unsigned char damage;
+    int loopStart[PATTERN_MAX_DEPTH];
+    int loopCount[PATTERN_MAX_DEPTH];
+    int depth;
+} Emitter;
+
+// Builds the shared direction table. Emitters build it on first use; call it
+// first when emitters will run on several threads.
+void InitPatterns(void);
+Emitter CreateEmitter(const unsigned char *program, int damage);
+// Runs the program until it waits or ends, spawning bullets around origin
+void RunEmitter(Emitter *emitter, BulletField *field, Vector2 origin, Vector2 target);
+
+#endif
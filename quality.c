@@ -0,0 +1,108 @@
+#include "quality.h"
+
+#define QUALITY_DOWN_LOAD 0.9f           // Share of the budget the average may reach before a step down
+#define QUALITY_UP_LOAD 0.5f             // Share of the budget the average must stay under to step up
+#define QUALITY_CLIMB_FRAMES 180
+#define QUALITY_MAX_CLIMB_FRAMES (QUALITY_CLIMB_FRAMES * 16)
+#define QUALITY_SETTLE_FRAMES 600        // A climb that holds this long clears the backoff
+
+// Sprite detail runs from a thumbnail up to several times the on-screen size
+static const QualitySettings qualitySettings[QUALITY_TIERS] = {
+    [QUALITY_LOW] = { "Low", 106, false },
+    [QUALITY_MEDIUM] = { "Medium", 284, false },
+    [QUALITY_HIGH] = { "High", 426, true },
+    [QUALITY_ULTRA] = { "Ultra", 852, true },
+};
+
+static void ClearLoadWindow(QualityGovernor *governor) {
+    governor->sampleCount = 0;
+    governor->next = 0;
+    governor->total = 0.0f;
+    governor->framesUnderBudget = 0;
+}
+
+QualityGovernor CreateQualityGovernor(float frameBudget) {
+    return (QualityGovernor){
+        .enabled = true,
+        .tier = QUALITY_ULTRA,
+        .frameBudget = frameBudget,
+        .climbDelay = QUALITY_CLIMB_FRAMES,
+        .framesSinceClimb = QUALITY_SETTLE_FRAMES,
+    };
+}
+
+void ObserveQualityLoad(QualityGovernor *governor, float frameLoad) {
+    if (!governor->enabled) return;
+
+    if (governor->framesSinceClimb < QUALITY_SETTLE_FRAMES && ++governor->framesSinceClimb == QUALITY_SETTLE_FRAMES) {
+        governor->climbDelay = QUALITY_CLIMB_FRAMES;
+    }
+
+    if (governor->sampleCount == QUALITY_WINDOW) {
+        governor->total -= governor->samples[governor->next];
+    } else {
+        governor->sampleCount++;
+    }
+    governor->samples[governor->next] = frameLoad;
+    governor->total += frameLoad;
+    governor->next = (governor->next + 1) % QUALITY_WINDOW;
+
+    // Every change starts a fresh window, so the next decision only sees frames drawn at the new tier
+    if (governor->sampleCount < QUALITY_WINDOW) return;
+    float average = governor->total / QUALITY_WINDOW;
+
+    if (average > governor->frameBudget * QUALITY_DOWN_LOAD) {
+        if (governor->tier == QUALITY_LOW) return;
+        // Falling straight back from a climb means the tier above does not fit yet
+        if (governor->framesSinceClimb < QUALITY_SETTLE_FRAMES && governor->climbDelay < QUALITY_MAX_CLIMB_FRAMES) {
+            governor->climbDelay *= 2;
+        }
+        governor->framesSinceClimb = QUALITY_SETTLE_FRAMES;
+        governor->tier--;
+        ClearLoadWindow(governor);
+    } else if (average < governor->frameBudget * QUALITY_UP_LOAD) {
+        if (governor->tier == QUALITY_ULTRA) return;
+        if (++governor->framesUnderBudget >= governor->climbDelay) {
+            governor->tier++;
+            governor->framesSinceClimb = 0;
+            ClearLoadWindow(governor);
+        }
+    } else {
+        governor->framesUnderBudget = 0;
+    }
+}
+
+void SetQualityGovernorEnabled(QualityGovernor *governor, bool enabled) {
+    governor->enabled = enabled;
+    governor->tier = QUALITY_ULTRA;
+    governor->climbDelay = QUALITY_CLIMB_FRAMES;
+    governor->framesSinceClimb = QUALITY_SETTLE_FRAMES;
+    ClearLoadWindow(governor);
+}
+
+const QualitySettings *GetQualitySettings(QualityTier tier) {
+    return &qualitySettings[tier];
+}
+
+void LoadDetailTextures(Image image, Texture2D textures[QUALITY_TIERS]) {
+    int longest = (image.width > image.height) ? image.width : image.height;
+    for (int i = 0; i < QUALITY_TIERS; i++) {
+        int detail = qualitySettings[i].spriteDetail;
+        if (longest <= detail) {
+            textures[i] = LoadTextureFromImage(image);
+            continue;
+        }
+        Image scaled = ImageCopy(image);
+        int width = image.width * detail / longest;
+        int height = image.height * detail / longest;
+        ImageResize(&scaled, (width > 0) ? width : 1, (height > 0) ? height : 1);
+        textures[i] = LoadTextureFromImage(scaled);
+        UnloadImage(scaled);
+    }
+}
+
+void UnloadDetailTextures(Texture2D textures[QUALITY_TIERS]) {
+    for (int i = 0; i < QUALITY_TIERS; i++) {
+        UnloadTexture(textures[i]);
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef QUALITY_H
+#define QUALITY_H
+
+#include "raylib.h"
+
+#define QUALITY_WINDOW 120               // Frames of load the governor averages before it decides
+
+typedef enum QualityTier {
+    QUALITY_LOW,
+    QUALITY_MEDIUM,
+    QUALITY_HIGH,
+    QUALITY_ULTRA,
+    QUALITY_TIERS
+} QualityTier;
+
+// What a tier spends on presentation. Nothing here reaches the simulation,
+// so replays, rollback and the training environment never see the tier.
+typedef struct QualitySettings {
+    const char *name;
+    int spriteDetail;                    // Longest side, in pixels, of the large sprite sheets
+    bool waterLayer;                     // Scrolling water texture showing through the background tint
+} QualitySettings;
+
+// Steps presentation detail down when the average frame load over the last
+// window nears the budget and back up once it has stayed well below it.
+// Both thresholds sit under the canvas's, so under a steady load effects
+// give way before resolution does and come back after it. A tier that was
+// climbed to and then overloaded is retried only after a wait that doubles
+// each time.
+typedef struct QualityGovernor {
+    bool enabled;                        // Off holds the top tier
+    QualityTier tier;
+    float frameBudget;
+    float samples[QUALITY_WINDOW];
+    int sampleCount;
+    int next;
+    float total;
+    int framesUnderBudget;
+    int climbDelay;                      // Quiet frames needed before the next step up
+    int framesSinceClimb;
+} QualityGovernor;
+
+QualityGovernor CreateQualityGovernor(float frameBudget);
+// Called every frame of play with that frame's measured work time
+void ObserveQualityLoad(QualityGovernor *governor, float frameLoad);
+void SetQualityGovernorEnabled(QualityGovernor *governor, bool enabled);
+const QualitySettings *GetQualitySettings(QualityTier tier);
+// One texture per tier, scaled down from image to each tier's sprite detail; never scaled up
+void LoadDetailTextures(Image image, Texture2D textures[QUALITY_TIERS]);
+void UnloadDetailTextures(Texture2D textures[QUALITY_TIERS]);
+
+#endif
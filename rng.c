@@ -0,0 +1,27 @@
+#include "rng.h"
+
+Rng SeedRng(unsigned int seed) {
+    // Zero is the one state xorshift never leaves
+    return (Rng){ seed != 0 ? seed : 0x9E3779B9u };
+}
+
+unsigned int NextRng(Rng *rng) {
+    unsigned int x = rng->state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng->state = x;
+    return x;
+}
+
+int GetRngValue(Rng *rng, int min, int max) {
+    if (max < min) {
+        int swap = min;
+        min = max;
+        max = swap;
+    }
+    unsigned int range = (unsigned int)(max - min) + 1u;
+    // A full 32-bit range wraps to zero and needs no reduction
+    if (range == 0) return (int)NextRng(rng);
+    return min + (int)(NextRng(rng) % range);
+}
@@ -0,0 +1,16 @@
+#ifndef RNG_H
+#define RNG_H
+
+// Small seeded generator (xorshift32) for everything the simulation rolls.
+// Its whole state is one integer, so it is saved and restored with the game
+// and a replay from the same seed rolls the same numbers on every machine.
+typedef struct Rng {
+    unsigned int state;
+} Rng;
+
+Rng SeedRng(unsigned int seed);
+unsigned int NextRng(Rng *rng);
+// Uniform in [min, max], like GetRandomValue
+int GetRngValue(Rng *rng, int min, int max);
+
+#endif
@@ -0,0 +1,126 @@
+#include "rollback.h"
+#include "raylib.h"
+#include <stdlib.h>
+
+static void SendPacket(LoopbackLink *link, LoopbackPacket packet) {
+    if (link->count == LOOPBACK_CAPACITY) return;
+    link->packets[(link->head + link->count) % LOOPBACK_CAPACITY] = packet;
+    link->count++;
+}
+
+// Packets go out in tick order with a fixed delay, so they also arrive in order
+static bool ReceivePacket(LoopbackLink *link, int now, LoopbackPacket *packet) {
+    if (link->count == 0 || link->packets[link->head].arrival > now) return false;
+    *packet = link->packets[link->head];
+    link->head = (link->head + 1) % LOOPBACK_CAPACITY;
+    link->count--;
+    return true;
+}
+
+static RollbackFrame *GetFrame(RollbackSession *session, int tick) {
+    return &session->frames[tick % ROLLBACK_WINDOW];
+}
+
+// Unconfirmed inputs repeat the player's last confirmed one
+static void PredictInputs(RollbackSession *session, RollbackFrame *frame) {
+    for (int p = 0; p < session->playerCount; p++) {
+        if (!frame->confirmed[p]) {
+            frame->inputs[p] = session->lastConfirmed[p];
+            // An edge that was predicted would fire twice; only the real input may carry it
+            frame->inputs[p].buttons &= INPUT_BOOST;
+        }
+    }
+}
+
+RollbackSession *LoadRollbackSession(void *context, RollbackSaveFn save, RollbackLoadFn load, RollbackTickFn simulate) {
+    RollbackSession *session = calloc(1, sizeof(RollbackSession));
+    if (session == NULL) return NULL;
+
+    session->context = context;
+    session->save = save;
+    session->load = load;
+    session->simulate = simulate;
+    for (int i = 0; i < ROLLBACK_WINDOW; i++) {
+        session->frames[i].state = LoadSnapshot(4096);
+    }
+    return session;
+}
+
+void UnloadRollbackSession(RollbackSession *session) {
+    if (session == NULL) return;
+    for (int i = 0; i < ROLLBACK_WINDOW; i++) {
+        UnloadSnapshot(session->frames[i].state);
+    }
+    free(session);
+}
+
+void ResetRollbackSession(RollbackSession *session, int playerCount, unsigned int remoteMask, int delay) {
+    session->tick = 0;
+    session->playerCount = (playerCount < ROLLBACK_MAX_PLAYERS) ? playerCount : ROLLBACK_MAX_PLAYERS;
+    for (int p = 0; p < ROLLBACK_MAX_PLAYERS; p++) {
+        session->remote[p] = (remoteMask >> p) & 1u;
+        session->lastConfirmed[p] = (PlayerInput){ 0 };
+    }
+
+    // An input later than the history window could not be rolled back to
+    session->link = (LoopbackLink){ 0 };
+    session->link.delay = (delay < ROLLBACK_WINDOW - 1) ? delay : ROLLBACK_WINDOW - 1;
+    if (session->link.delay < 0) session->link.delay = 0;
+
+    session->resimulatedTicks = 0;
+    session->resimulateTime = 0.0;
+}
+
+void AdvanceRollback(RollbackSession *session, const PlayerInput *inputs) {
+    int now = session->tick;
+    bool anyRemote = false;
+    RollbackFrame *current = GetFrame(session, now);
+
+    for (int p = 0; p < session->playerCount; p++) {
+        current->confirmed[p] = !session->remote[p];
+        if (session->remote[p]) {
+            anyRemote = true;
+            SendPacket(&session->link, (LoopbackPacket){ p, now, now + session->link.delay, inputs[p] });
+        } else {
+            current->inputs[p] = inputs[p];
+            session->lastConfirmed[p] = inputs[p];
+        }
+    }
+
+    // Confirm whatever arrived; the earliest tick that was guessed wrong is where resimulation starts
+    int rollbackFrom = now;
+    LoopbackPacket packet;
+    while (ReceivePacket(&session->link, now, &packet)) {
+        RollbackFrame *frame = GetFrame(session, packet.tick);
+        if (packet.tick < now && !InputEquals(frame->inputs[packet.player], packet.input) && packet.tick < rollbackFrom) {
+            rollbackFrom = packet.tick;
+        }
+        frame->inputs[packet.player] = packet.input;
+        frame->confirmed[packet.player] = true;
+        session->lastConfirmed[packet.player] = packet.input;
+    }
+
+    if (rollbackFrom < now) {
+        double start = GetTime();
+        session->load(session->context, &GetFrame(session, rollbackFrom)->state);
+        session->resimulating = true;
+        for (int tick = rollbackFrom; tick < now; tick++) {
+            RollbackFrame *frame = GetFrame(session, tick);
+            PredictInputs(session, frame);
+            if (tick > rollbackFrom) session->save(session->context, &frame->state);
+            session->simulate(session->context, frame->inputs);
+        }
+        session->resimulating = false;
+
+        session->resimulatedTicks = now - rollbackFrom;
+        session->resimulateTime = GetTime() - start;
+        if (session->resimulatedTicks > session->peakResimulatedTicks) session->peakResimulatedTicks = session->resimulatedTicks;
+        if (session->resimulateTime > session->peakResimulateTime) session->peakResimulateTime = session->resimulateTime;
+    }
+
+    // Without remote players nothing can be rolled back, so no history is kept
+    PredictInputs(session, current);
+    if (anyRemote) session->save(session->context, &current->state);
+    session->simulate(session->context, current->inputs);
+    session->tick++;
+}
@@ -0,0 +1,69 @@
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include "input.h"
+#include "snapshot.h"
+
+#define ROLLBACK_MAX_PLAYERS 2
+#define ROLLBACK_WINDOW 16       // Ticks of history; the latest an input may arrive
+#define LOOPBACK_CAPACITY (ROLLBACK_WINDOW * ROLLBACK_MAX_PLAYERS)
+
+typedef bool (*RollbackSaveFn)(void *context, Snapshot *snapshot);
+typedef bool (*RollbackLoadFn)(void *context, Snapshot *snapshot);
+typedef void (*RollbackTickFn)(void *context, const PlayerInput *inputs);
+
+// The state before one tick and the inputs that tick ran with
+typedef struct RollbackFrame {
+    Snapshot state;
+    PlayerInput inputs[ROLLBACK_MAX_PLAYERS];
+    bool confirmed[ROLLBACK_MAX_PLAYERS];
+} RollbackFrame;
+
+typedef struct LoopbackPacket {
+    int player;
+    int tick;
+    int arrival;
+    PlayerInput input;
+} LoopbackPacket;
+
+// Stand-in for a network link: every packet arrives delay ticks after it was sent
+typedef struct LoopbackLink {
+    LoopbackPacket packets[LOOPBACK_CAPACITY];
+    int head;
+    int count;
+    int delay;
+} LoopbackLink;
+
+// Runs a deterministic simulation one tick at a time. Remote players' inputs
+// are predicted (their last known input repeats) until the real ones arrive;
+// a wrong guess restores the state before that tick and resimulates up to now.
+typedef struct RollbackSession {
+    RollbackFrame frames[ROLLBACK_WINDOW];
+    int tick;                                        // Next tick to simulate
+    int playerCount;
+    bool remote[ROLLBACK_MAX_PLAYERS];
+    PlayerInput lastConfirmed[ROLLBACK_MAX_PLAYERS];
+    LoopbackLink link;
+
+    void *context;
+    RollbackSaveFn save;
+    RollbackLoadFn load;
+    RollbackTickFn simulate;
+    bool resimulating;                               // Set while simulate replays ticks that already ran
+
+    // Cost of the last and the worst rollback, to check it fits the frame budget
+    int resimulatedTicks;
+    int peakResimulatedTicks;
+    double resimulateTime;
+    double peakResimulateTime;
+} RollbackSession;
+
+RollbackSession *LoadRollbackSession(void *context, RollbackSaveFn save, RollbackLoadFn load, RollbackTickFn simulate);
+void UnloadRollbackSession(RollbackSession *session);
+// Forgets all history; remoteMask has a bit per player whose input goes through the loopback link
+void ResetRollbackSession(RollbackSession *session, int playerCount, unsigned int remoteMask, int delay);
+// Simulates one tick. inputs holds this tick's input for every player; remote
+// players' entries are sent over the link and only take effect once they arrive.
+void AdvanceRollback(RollbackSession *session, const PlayerInput *inputs);
+
+#endif
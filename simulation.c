@@ -0,0 +1,112 @@
+#include "simulation.h"
+
+static void ScoreSystem(RunState *run, const EventQueue *events) {
+    for (int i = 0; i < events->count; i++) {
+        if (events->events[i].type == EVENT_KILL) run->score += events->events[i].value;
+    }
+}
+
+static void VictorySystem(RunState *run, const EventQueue *events) {
+    for (int i = 0; i < events->count; i++) {
+        const GameEvent *event = &events->events[i];
+        if (event->type == EVENT_KILL && (event->flags & EVENT_FLAG_BOSS)) run->bossDefeated = true;
+    }
+}
+
+// A kill refills the energy and health of the submarine that made it, if it is still in the fight
+static void KillRewardSystem(RunState *run, World *world, const EventQueue *events) {
+    for (int p = 0; p < run->playerCount; p++) {
+        Player *subState = GetComponent(world, run->players[p], COMPONENT_PLAYER);
+        Health *subHealth = GetComponent(world, run->players[p], COMPONENT_HEALTH);
+        if (subHealth->current <= 0) continue;
+
+        int kills = 0;
+        for (int i = 0; i < events->count; i++) {
+            if (events->events[i].type == EVENT_KILL && events->events[i].slot == subState->slot) kills++;
+        }
+        if (kills == 0) continue;
+
+        subState->energy += run->stats.killEnergy * kills;
+        if (subState->energy > 100.0f) {
+            subState->energy = 100.0f;
+        }
+        subHealth->current += (int)run->stats.killHeal * kills;
+        if (subHealth->current > subHealth->max) {
+            subHealth->current = subHealth->max;
+        }
+    }
+}
+
+bool AddRunBuff(RunState *run, World *world, BuffId buff, const GameConfig *config) {
+    const BuffDef *def = GetBuffDef(buff);
+    if (run->buffStacks[buff] >= def->maxStacks) return false;
+    run->buffStacks[buff]++;
+
+    run->stats = ResolveRunStats(run->buffStacks, config);
+
+    for (int p = 0; p < run->playerCount; p++) {
+        Player *state = GetComponent(world, run->players[p], COMPONENT_PLAYER);
+        Health *health = GetComponent(world, run->players[p], COMPONENT_HEALTH);
+        if (def->effects & BUFF_EFFECT_REFILL_ENERGY) {
+            state->energy = 100.0f;
+        }
+        if (def->effects & BUFF_EFFECT_RESTORE_HEALTH) {
+            health->current = health->max;
+        }
+        // A shorter cooldown applies to the special attack already waiting
+        if (state->specialTimer > run->stats.specialCooldown) {
+            state->specialTimer = run->stats.specialCooldown;
+        }
+    }
+    return true;
+}
+
+int GetRunEventCapacity(const World *world) {
+    // Per tick an entity is killed at most once and touches each submarine at most once,
+    // and bullet hits are one event per submarine
+    return world->capacity * (1 + MAX_PLAYERS);
+}
+
+void StepRun(RunState *run, World *world, BulletField *bullets, FlowField *flow, const SpriteMasks *masks, TileMap *cavern, EventQueue *events, Arena *scratch, const GameConfig *config, const PlayerInput *inputs) {
+    size_t scratchMark = GetArenaMark(scratch);
+    run->timer += SIM_TICK;
+
+    ClearEventQueue(events);
+
+    // Submarine movement, speed boost and shooting
+    PlayerControlSystem(world, inputs, &run->stats, config, SIM_TICK);
+
+    // Move everything, let shooters fire, then resolve hits on the submarines and on enemies
+    SteeringSystem(world, flow);
+    MovementSystem(world, config);
+    if (cavern != NULL && run->cavern.active) {
+        CavernSystem(world, bullets, cavern, &run->cavern, config, SIM_TICK);
+    }
+    ShooterSystem(world, bullets, config, SIM_TICK);
+    EmitterSystem(world, bullets);
+    EnemyBulletSystem(world, bullets, masks, events, config);
+    ContactSystem(world, masks, events);
+    ProjectileSystem(world, events, scratch);
+
+    // Everything collision queued this tick is applied in one pass per reaction
+    ScoreSystem(run, events);
+    KillRewardSystem(run, world, events);
+    VictorySystem(run, events);
+
+    // Waves without a buff screen after them roll on inside the simulation
+    bool cleared = CountEntities(world, HAS_HEALTH | HAS_ENEMY, 0) == 0;
+    if (cleared && !run->endless && !run->bossDefeated && CountLivePlayers(world) > 0 &&
+        run->wave != 2 && run->wave != 4 && run->wave < config->maxWaves) {
+        run->wave++;
+        run->maxEnemies = (run->wave == 5) ? 1 : run->wave * 5;
+        for (int p = 0; p < run->playerCount; p++) {
+            ((Player *)GetComponent(world, run->players[p], COMPONENT_PLAYER))->speed += 1;
+        }
+        SpawnWave(world, &run->rng, run->wave, run->maxEnemies, run->difficultyLevel, config);
+    }
+
+    AnimationSystem(world, config, SIM_TICK);
+
+    // Collision lists only live for the tick
+    RewindArena(scratch, scratchMark);
+}
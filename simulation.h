@@ -0,0 +1,48 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "systems.h"
+#include "events.h"
+#include "buffs.h"
+
+// The simulation always advances in steps of this many seconds
+#define SIM_TICK (1.0f / 60.0f)
+
+// Progress of the current run; plain data so a snapshot copies it as one block
+typedef struct RunState {
+    int wave;
+    int maxEnemies;
+    int score;
+    int difficultyLevel;
+    float timer;
+    unsigned char buffStacks[BUFF_COUNT];
+    RunStats stats;              // Resolved from buffStacks whenever they or the tuning change
+    bool practice;               // Resumed from a checkpoint; the time does not count as a record
+    bool bossDefeated;           // Set by the tick that destroys the boss
+    bool endless;                // Waves never end; the spawn director plans each one
+    int waveEnemies;             // Enemies the current endless wave started with
+    float waveStartTime;
+    int playerCount;
+    Entity players[MAX_PLAYERS];
+    Rng rng;                     // Every random roll the simulation makes
+    CavernState cavern;          // The level scrolls through a cavern when active
+} RunState;
+
+// Adds a stack of buff, applies its instant effects to every submarine and
+// resolves the stats again. False when the buff is already at its limit.
+bool AddRunBuff(RunState *run, World *world, BuffId buff, const GameConfig *config);
+
+// One fixed step of the game. Everything it reads is in run, the world, the
+// bullets or inputs, so running it again from a restored state gives the same
+// result. Needs no window: the game and the training library both drive it.
+// masks may be NULL, leaving collisions to rectangles; cavern may be NULL when
+// the run never turns its cavern on. events, sized by the caller, is cleared
+// and left holding what happened during the tick for the caller to present.
+// The tick's temporaries come from scratch, which is rewound to where it was
+// before StepRun returns.
+// Room for every event world's entities can raise in one tick, so none is ever
+// dropped. Size the queue with it after loading or growing the world.
+int GetRunEventCapacity(const World *world);
+void StepRun(RunState *run, World *world, BulletField *bullets, FlowField *flow, const SpriteMasks *masks, TileMap *cavern, EventQueue *events, Arena *scratch, const GameConfig *config, const PlayerInput *inputs);
+
+#endif
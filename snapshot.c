@@ -0,0 +1,53 @@
+#include "snapshot.h"
+#include <stdlib.h>
+#include <string.h>
+
+Snapshot LoadSnapshot(size_t capacity) {
+    Snapshot snapshot = { 0 };
+    snapshot.data = malloc(capacity);
+    if (snapshot.data != NULL) snapshot.capacity = capacity;
+    return snapshot;
+}
+
+void UnloadSnapshot(Snapshot snapshot) {
+    free(snapshot.data);
+}
+
+void ClearSnapshot(Snapshot *snapshot) {
+    snapshot->size = 0;
+    snapshot->readOffset = 0;
+}
+
+bool IsSnapshotEmpty(const Snapshot *snapshot) {
+    return snapshot->size == 0;
+}
+
+bool WriteSnapshot(Snapshot *snapshot, const void *block, size_t size) {
+    if (size == 0) return true;
+    if (snapshot->size + size > snapshot->capacity) {
+        size_t capacity = (snapshot->capacity > 0) ? snapshot->capacity : 4096;
+        while (capacity < snapshot->size + size) capacity *= 2;
+
+        unsigned char *data = realloc(snapshot->data, capacity);
+        if (data == NULL) return false;
+        snapshot->data = data;
+        snapshot->capacity = capacity;
+    }
+
+    memcpy(snapshot->data + snapshot->size, block, size);
+    snapshot->size += size;
+    return true;
+}
+
+void RewindSnapshot(Snapshot *snapshot) {
+    snapshot->readOffset = 0;
+}
+
+bool ReadSnapshot(Snapshot *snapshot, void *block, size_t size) {
+    if (size == 0) return true;
+    if (snapshot->readOffset + size > snapshot->size) return false;
+
+    memcpy(block, snapshot->data + snapshot->readOffset, size);
+    snapshot->readOffset += size;
+    return true;
+}
@@ -0,0 +1,28 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Flat byte image of game state, built by appending plain-data blocks and
+// restored by reading them back in the same order. The buffer is kept between
+// saves, so once it has grown to fit a save costs a handful of memcpys.
+// Blocks may hold pointers to static data (pattern programs), so a snapshot
+// is only meaningful to the process that took it.
+typedef struct Snapshot {
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+    size_t readOffset;
+} Snapshot;
+
+Snapshot LoadSnapshot(size_t capacity);
+void UnloadSnapshot(Snapshot snapshot);
+void ClearSnapshot(Snapshot *snapshot);
+bool IsSnapshotEmpty(const Snapshot *snapshot);
+bool WriteSnapshot(Snapshot *snapshot, const void *block, size_t size);
+// Starts reading from the first block again
+void RewindSnapshot(Snapshot *snapshot);
+bool ReadSnapshot(Snapshot *snapshot, void *block, size_t size);
+
+#endif
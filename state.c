@@ -0,0 +1,118 @@
+#include "state.h"
+#include <stddef.h>
+
+static void EnterState(StateStack *stack, int state) {
+    if (stack->depth == STATE_STACK_DEPTH || state < 0 || state >= stack->stateCount) return;
+
+    stack->stack[stack->depth++] = state;
+    if (stack->states[state].enter != NULL) stack->states[state].enter(stack->context);
+}
+
+static void LeaveState(StateStack *stack) {
+    if (stack->depth == 0) return;
+
+    int state = stack->stack[--stack->depth];
+    if (stack->states[state].exit != NULL) stack->states[state].exit(stack->context);
+}
+
+static void QueueTransition(StateStack *stack, StateTransitionType type, int state) {
+    if (stack->queued == STATE_QUEUE_SIZE) return;
+    stack->queue[stack->queued++] = (StateTransition){ type, state };
+}
+
+StateStack CreateStateStack(const StateDesc *states, int stateCount, void *context, int initial) {
+    StateStack stack = { 0 };
+    stack.states = states;
+    stack.stateCount = stateCount;
+    stack.context = context;
+    QueueTransition(&stack, STATE_PUSH, initial);
+    return stack;
+}
+
+void PushState(StateStack *stack, int state) {
+    QueueTransition(stack, STATE_PUSH, state);
+}
+
+void PopState(StateStack *stack) {
+    QueueTransition(stack, STATE_POP, -1);
+}
+
+void SwitchState(StateStack *stack, int state) {
+    QueueTransition(stack, STATE_SWITCH, state);
+}
+
+void ResetStates(StateStack *stack, int state) {
+    QueueTransition(stack, STATE_RESET, state);
+}
+
+int GetCurrentState(const StateStack *stack) {
+    return (stack->depth > 0) ? stack->stack[stack->depth - 1] : -1;
+}
+
+static void ApplyTransitions(StateStack *stack) {
+    // Enter callbacks may queue more transitions; those run in this same pass
+    for (int i = 0; i < stack->queued; i++) {
+        StateTransition transition = stack->queue[i];
+        switch (transition.type) {
+            case STATE_PUSH:
+                EnterState(stack, transition.state);
+                break;
+            case STATE_POP:
+                LeaveState(stack);
+                break;
+            case STATE_SWITCH:
+                LeaveState(stack);
+                EnterState(stack, transition.state);
+                break;
+            case STATE_RESET:
+                while (stack->depth > 0) LeaveState(stack);
+                EnterState(stack, transition.state);
+                break;
+        }
+        stack->sceneValid = false;
+    }
+    stack->queued = 0;
+}
+
+void UpdateStates(StateStack *stack, float deltaTime) {
+    ApplyTransitions(stack);
+
+    int state = GetCurrentState(stack);
+    if (state >= 0 && stack->states[state].update != NULL) {
+        stack->states[state].update(stack->context, deltaTime);
+    }
+}
+
+void DrawStates(StateStack *stack, Canvas *canvas) {
+    if (stack->depth == 0) return;
+
+    int top = stack->depth - 1;
+    int base = top;
+    while (base > 0 && stack->states[stack->stack[base]].overlay) base--;
+
+    // Nothing under an overlay moves, so its last frame can simply be shown again
+    bool frozen = base < top && stack->sceneValid;
+    if (!frozen) {
+        BeginCanvas(canvas);
+        const StateDesc *desc = &stack->states[stack->stack[base]];
+        if (desc->draw != NULL) desc->draw(stack->context);
+        EndCanvasScene(canvas);
+    }
+
+    for (int i = base + 1; i <= top; i++) {
+        const StateDesc *desc = &stack->states[stack->stack[i]];
+        if (desc->draw != NULL) desc->draw(stack->context);
+    }
+
+    if (frozen) {
+        PresentCanvas(canvas);
+    } else {
+        EndCanvas(canvas);
+    }
+    stack->sceneValid = true;
+}
+
+void CloseStates(StateStack *stack) {
+    stack->queued = 0;
+    while (stack->depth > 0) LeaveState(stack);
+}
@@ -0,0 +1,65 @@
+#ifndef STATE_H
+#define STATE_H
+
+#include "raylib.h"
+#include "canvas.h"
+
+#define STATE_STACK_DEPTH 8
+#define STATE_QUEUE_SIZE 8
+
+typedef void (*StateFn)(void *context);
+typedef void (*StateUpdateFn)(void *context, float deltaTime);
+
+// Callbacks for one state; any of them may be NULL. A state's draw renders the
+// scene into the canvas, except for overlay states, whose draw may only add
+// canvas overlays (UI layers).
+typedef struct StateDesc {
+    StateFn enter;
+    StateFn exit;
+    StateUpdateFn update;
+    StateFn draw;
+    bool overlay;       // Shown over the state below, which is frozen: not updated and not redrawn
+} StateDesc;
+
+typedef enum StateTransitionType {
+    STATE_PUSH,
+    STATE_POP,
+    STATE_SWITCH,       // Replace the top state
+    STATE_RESET         // Pop everything, then push
+} StateTransitionType;
+
+typedef struct StateTransition {
+    StateTransitionType type;
+    int state;
+} StateTransition;
+
+// Stack of game states. Transitions requested during a frame are queued and
+// applied at the start of the next update, so no state changes under the
+// callbacks that are still running.
+typedef struct StateStack {
+    const StateDesc *states;
+    int stateCount;
+    void *context;
+    int stack[STATE_STACK_DEPTH];
+    int depth;
+    StateTransition queue[STATE_QUEUE_SIZE];
+    int queued;
+    bool sceneValid;    // The frozen scene under an overlay is still on the canvas
+} StateStack;
+
+StateStack CreateStateStack(const StateDesc *states, int stateCount, void *context, int initial);
+void PushState(StateStack *stack, int state);
+void PopState(StateStack *stack);
+void SwitchState(StateStack *stack, int state);
+void ResetStates(StateStack *stack, int state);
+// Top of the stack, -1 when empty
+int GetCurrentState(const StateStack *stack);
+// Applies queued transitions, then updates the top state only
+void UpdateStates(StateStack *stack, float deltaTime);
+// Redraws the topmost non-overlay state unless it is frozen under an overlay,
+// in which case the previous canvas contents are presented again
+void DrawStates(StateStack *stack, Canvas *canvas);
+// Pops every state, running their exit callbacks
+void CloseStates(StateStack *stack);
+
+#endif
@@ -0,0 +1,881 @@
+#include "systems.h"
+#include "collision.h"
+#include <stdio.h>
+#include <math.h>
+
+#define ENEMY_BULLET_SPEED 5.0f
+#define ENEMY_BULLET_DAMAGE 10
+#define BOSS_BULLET_DAMAGE 5
+#define PLAYER_BULLET_SPEED 10.0f
+#define ROCKET_PIERCE 3
+#define PLAYER_SPAWN_SPACING 120.0f
+#define ROCKET_FRAME_TIME 0.1f
+#define ENEMY_ANIM_CYCLE 30.0f   // Distance over which the three enemy frames play
+#define SEPARATION_RADIUS 48.0f
+#define SEPARATION_WEIGHT 1.5f
+#define ENEMY_SIZE 64
+#define BOSS_SIZE 200
+#define MASK_ALPHA_THRESHOLD 127
+#define CRUSH_DAMAGE 1               // Per tick pinned between rock and the bottom of the screen
+
+// Boss fight, looping forever: a four-armed spiral, aimed fans, offset rings
+// and a fast six-armed spiral
+static const unsigned char bossPattern[] = {
+    PATTERN_SPEED, 25, PATTERN_SIZE, 8, PATTERN_COLOR, 0,
+    PATTERN_REPEAT, 120, PATTERN_RADIAL, 4, PATTERN_TURN, 5, PATTERN_WAIT, 2, PATTERN_LOOP,
+    PATTERN_WAIT, 30,
+    PATTERN_SPEED, 40, PATTERN_SIZE, 6, PATTERN_COLOR, 1,
+    PATTERN_REPEAT, 5, PATTERN_AIM, PATTERN_FAN, 7, 24, PATTERN_WAIT, 20, PATTERN_LOOP,
+    PATTERN_WAIT, 30,
+    PATTERN_SPEED, 20, PATTERN_SIZE, 10, PATTERN_COLOR, 2,
+    PATTERN_REPEAT, 6, PATTERN_RADIAL, 32, PATTERN_TURN, 4, PATTERN_WAIT, 25, PATTERN_LOOP,
+    PATTERN_SPEED, 30, PATTERN_SIZE, 6, PATTERN_COLOR, 3,
+    PATTERN_REPEAT, 90, PATTERN_RADIAL, 6, PATTERN_TURN, 253, PATTERN_WAIT, 3, PATTERN_LOOP,
+    PATTERN_WAIT, 30,
+    PATTERN_JUMP, 0
+};
+
+static Rectangle GetPlayerHitbox(const Transform *transform, const Player *player) {
+    return (Rectangle){
+        transform->rect.x + (transform->rect.width - player->hitboxSize.x) / 2,
+        transform->rect.y + 20,
+        player->hitboxSize.x,
+        player->hitboxSize.y
+    };
+}
+
+// Live submarines in spawn order, so every system visits them the same way each tick
+typedef struct PlayerView {
+    Rectangle hitbox;
+    Vector2 center;
+    Player *state;
+    Health *health;
+    Rectangle body;              // Where the sprite is drawn
+    const Sprite *sprite;
+} PlayerView;
+
+static int GatherLivePlayers(World *world, PlayerView *out) {
+    Archetype *matches[ECS_MAX_ARCHETYPES];
+    int matchCount = QueryArchetypes(world, HAS_TRANSFORM | HAS_HEALTH | HAS_PLAYER, 0, matches, ECS_MAX_ARCHETYPES);
+    int count = 0;
+
+    for (int m = 0; m < matchCount; m++) {
+        Archetype *archetype = matches[m];
+        Transform *transforms = archetype->columns[COMPONENT_TRANSFORM];
+        Health *healths = archetype->columns[COMPONENT_HEALTH];
+        Player *players = archetype->columns[COMPONENT_PLAYER];
+        Sprite *sprites = archetype->columns[COMPONENT_SPRITE];
+
+        for (int i = 0; i < archetype->count && count < MAX_PLAYERS; i++) {
+            if (healths[i].current <= 0) continue;
+            Rectangle hitbox = GetPlayerHitbox(&transforms[i], &players[i]);
+            out[count++] = (PlayerView){
+                hitbox, { hitbox.x + hitbox.width / 2, hitbox.y + hitbox.height / 2 }, &players[i], &healths[i],
+                transforms[i].rect, (sprites != NULL) ? &sprites[i] : NULL
+            };
+        }
+    }
+    return count;
+}
+
+// The mask drawn for sprite at rect's size, or NULL to keep the rectangle
+static const BitMask *GetSpriteMask(const SpriteMasks *masks, const Sprite *sprite, Rectangle rect) {
+    if (masks == NULL || sprite == NULL) return NULL;
+
+    const BitMask *mask;
+    switch (sprite->sheet) {
+        case SPRITE_SUBMARINE:
+            mask = &masks->submarine[sprite->flipX ? 1 : 0];
+            break;
+        case SPRITE_ENEMY:
+        case SPRITE_ENEMY_FRONT:
+            mask = (rect.width == BOSS_SIZE && sprite->frame < ENEMY_FRAMES) ? &masks->boss[sprite->frame] : &masks->enemy[sprite->frame];
+            break;
+        default:
+            return NULL;
+    }
+    // A mask is only exact at the size it was built for
+    if (mask->rows == NULL || mask->width != (int)rect.width || mask->height != (int)rect.height) return NULL;
+    return mask;
+}
+
+// Narrow phase once the rectangles overlap: solid pixels of the submarine and
+// of the other sprite meet inside the hitbox. A side without a mask is solid.
+static bool TouchesPlayer(const PlayerView *player, const SpriteMasks *masks, const Sprite *sprite, Rectangle rect) {
+    const BitMask *playerMask = GetSpriteMask(masks, player->sprite, player->body);
+    const BitMask *otherMask = GetSpriteMask(masks, sprite, rect);
+    int playerX = (int)floorf(player->body.x);
+    int playerY = (int)floorf(player->body.y);
+    int otherX = (int)floorf(rect.x);
+    int otherY = (int)floorf(rect.y);
+
+    if (playerMask != NULL && otherMask != NULL) {
+        return MasksOverlap(playerMask, playerX, playerY, otherMask, otherX, otherY, player->hitbox);
+    }
+    if (playerMask != NULL) return MaskOverlapsRect(playerMask, playerX, playerY, GetCollisionRec(rect, player->hitbox));
+    if (otherMask != NULL) return MaskOverlapsRect(otherMask, otherX, otherY, GetCollisionRec(rect, player->hitbox));
+    return true;
+}
+
+int CountLivePlayers(World *world) {
+    PlayerView players[MAX_PLAYERS];
+    return GatherLivePlayers(world, players);
+}
+
+SpriteMasks LoadSpriteMasks(Image submarine, const Image *enemy, const GameConfig *config) {
+    SpriteMasks masks = { 0 };
+    for (int flip = 0; flip < 2; flip++) {
+        masks.submarine[flip] = BuildBitMask(submarine, config->frameWidth, config->frameHeight * 2, MASK_ALPHA_THRESHOLD, flip == 1);
+    }
+    for (int i = 0; i < ENEMY_FRAMES * 2; i++) {
+        masks.enemy[i] = BuildBitMask(enemy[i], ENEMY_SIZE, ENEMY_SIZE, MASK_ALPHA_THRESHOLD, false);
+    }
+    for (int i = 0; i < ENEMY_FRAMES; i++) {
+        masks.boss[i] = BuildBitMask(enemy[i], BOSS_SIZE, BOSS_SIZE, MASK_ALPHA_THRESHOLD, false);
+    }
+    return masks;
+}
+
+void UnloadSpriteMasks(SpriteMasks masks) {
+    for (int flip = 0; flip < 2; flip++) UnloadBitMask(masks.submarine[flip]);
+    for (int i = 0; i < ENEMY_FRAMES * 2; i++) UnloadBitMask(masks.enemy[i]);
+    for (int i = 0; i < ENEMY_FRAMES; i++) UnloadBitMask(masks.boss[i]);
+}
+
+int GetEnemyCeiling(const GameConfig *config) {
+    return (config->maxEnemies > DIRECTOR_MAX_ENEMIES) ? config->maxEnemies : DIRECTOR_MAX_ENEMIES;
+}
+
+int GetWorldCapacity(const GameConfig *config) {
+    return MAX_PLAYERS * (1 + MAX_PLAYER_BULLETS) + 1 + GetEnemyCeiling(config);
+}
+
+void ReserveWorld(World *world, const GameConfig *config) {
+    int enemies = GetEnemyCeiling(config);
+    ReserveEntities(world, ARCHETYPE_PLAYER, MAX_PLAYERS);
+    ReserveEntities(world, ARCHETYPE_PLAYER_BULLET, MAX_PLAYER_BULLETS * MAX_PLAYERS);
+    ReserveEntities(world, ARCHETYPE_ENEMY, enemies);
+    ReserveEntities(world, ARCHETYPE_SHOOTER, enemies);
+    ReserveEntities(world, ARCHETYPE_CHASER, enemies);
+    ReserveEntities(world, ARCHETYPE_BOSS, 1);
+}
+
+void RetuneWorld(World *world, const GameConfig *config) {
+    GrowWorld(world, GetWorldCapacity(config));
+    ReserveWorld(world, config);
+
+    // Shooters copied the cooldown when they spawned; a shorter one applies to the shot already waiting
+    Archetype *matches[ECS_MAX_ARCHETYPES];
+    int matchCount = QueryArchetypes(world, HAS_SHOOTER, 0, matches, ECS_MAX_ARCHETYPES);
+    for (int m = 0; m < matchCount; m++) {
+        Shooter *shooters = matches[m]->columns[COMPONENT_SHOOTER];
+        for (int i = 0; i < matches[m]->count; i++) {
+            shooters[i].cooldown = config->shooterCooldown;
+            if (shooters[i].timer > config->shooterCooldown) shooters[i].timer = config->shooterCooldown;
+        }
+    }
+}
+
+Entity SpawnPlayer(World *world, const GameConfig *config, int slot) {
+    Entity player = SpawnEntity(world, ARCHETYPE_PLAYER);
+    if (player == ECS_INVALID_ENTITY) return player;
+
+    // The second submarine starts to the right of the first
+    Transform *transform = GetComponent(world, player, COMPONENT_TRANSFORM);
+    transform->rect = (Rectangle){
+        config->screenWidth / 2 - config->frameWidth / 2 + slot * PLAYER_SPAWN_SPACING,
+        config->screenHeight - 120,
+        (float)config->frameWidth * 1.0f,
+        (float)config->frameHeight * 2.0f
+    };
+
+    Player *state = GetComponent(world, player, COMPONENT_PLAYER);
+    state->hitboxSize = (Vector2){ config->frameWidth * 1.5f, config->frameHeight * 1.5f };
+    state->slot = slot;
+
+    Health *health = GetComponent(world, player, COMPONENT_HEALTH);
+    health->max = 100;
+
+    Sprite *sprite = GetComponent(world, player, COMPONENT_SPRITE);
+    sprite->sheet = SPRITE_SUBMARINE;
+
+    ResetPlayer(world, player);
+    return player;
+}
+
+void ResetPlayer(World *world, Entity player) {
+    Player *state = GetComponent(world, player, COMPONENT_PLAYER);
+    Health *health = GetComponent(world, player, COMPONENT_HEALTH);
+    Sprite *sprite = GetComponent(world, player, COMPONENT_SPRITE);
+    sprite->tint = (state->slot == 0) ? WHITE : SKYBLUE;
+    state->speed = 200;
+    state->energy = 100.0f;
+    state->specialTimer = 0.0f;
+    health->current = health->max;
+}
+
+bool SpawnPlayerBullet(World *world, Entity player, bool heavy) {
+    if (CountEntities(world, HAS_PROJECTILE, HAS_ENEMY) >= MAX_PLAYER_BULLETS * CountEntities(world, HAS_PLAYER, 0)) return false;
+
+    Rectangle origin = ((Transform *)GetComponent(world, player, COMPONENT_TRANSFORM))->rect;
+    Entity bullet = SpawnEntity(world, ARCHETYPE_PLAYER_BULLET);
+    if (bullet == ECS_INVALID_ENTITY) return false;
+
+    Transform *transform = GetComponent(world, bullet, COMPONENT_TRANSFORM);
+    Velocity *velocity = GetComponent(world, bullet, COMPONENT_VELOCITY);
+    Projectile *projectile = GetComponent(world, bullet, COMPONENT_PROJECTILE);
+    Sprite *sprite = GetComponent(world, bullet, COMPONENT_SPRITE);
+
+    float width = heavy ? 100 : 5;
+    float height = heavy ? 100 : 10;
+    // Centred on the submarine; the rocket art is offset to line up with the hull
+    transform->rect = (Rectangle){ origin.x + origin.width / 2 - width / 2 + (heavy ? 25.0f : 0.0f), origin.y, width, height };
+    velocity->value = (Vector2){ 0, -PLAYER_BULLET_SPEED };
+    projectile->damage = heavy ? 3 : 1;
+    projectile->owner = ((Player *)GetComponent(world, player, COMPONENT_PLAYER))->slot;
+    projectile->pierce = heavy ? ROCKET_PIERCE : 1;
+    sprite->sheet = heavy ? SPRITE_ROCKET : SPRITE_SOLID;
+    sprite->tint = heavy ? WHITE : RED;
+    return true;
+}
+
+typedef enum EnemyKind {
+    ENEMY_PATROLLER,
+    ENEMY_CHASER,
+    ENEMY_SHOOTER
+} EnemyKind;
+
+static Rectangle RollEnemyRect(Rng *rng, const GameConfig *config) {
+    return (Rectangle){
+        GetRngValue(rng, 0, config->screenWidth - 40),
+        GetRngValue(rng, 50, config->screenHeight / 2),
+        ENEMY_SIZE,
+        ENEMY_SIZE
+    };
+}
+
+static bool SpawnEnemy(World *world, Rng *rng, EnemyKind kind, Rectangle rect, int health, float speed, const GameConfig *config) {
+    ComponentMask archetype = (kind == ENEMY_SHOOTER) ? ARCHETYPE_SHOOTER : (kind == ENEMY_CHASER ? ARCHETYPE_CHASER : ARCHETYPE_ENEMY);
+    Entity enemy = SpawnEntity(world, archetype);
+    if (enemy == ECS_INVALID_ENTITY) return false;
+
+    ((Transform *)GetComponent(world, enemy, COMPONENT_TRANSFORM))->rect = rect;
+    *(Health *)GetComponent(world, enemy, COMPONENT_HEALTH) = (Health){ health, health };
+    *(Enemy *)GetComponent(world, enemy, COMPONENT_ENEMY) = (Enemy){ .contactDamage = 20, .scoreValue = 10 };
+    Velocity *velocity = GetComponent(world, enemy, COMPONENT_VELOCITY);
+    Sprite *sprite = GetComponent(world, enemy, COMPONENT_SPRITE);
+    sprite->tint = WHITE;
+
+    if (kind == ENEMY_SHOOTER) {
+        // Shooters patrol sideways at a fixed speed and fire downwards
+        velocity->value = (Vector2){ GetRngValue(rng, 0, 1) * 2 - 1, 0 };
+        velocity->value.x *= 2;
+        *(Shooter *)GetComponent(world, enemy, COMPONENT_SHOOTER) = (Shooter){
+            .cooldown = config->shooterCooldown, .bulletSize = { 5, 10 }, .bulletSpeed = ENEMY_BULLET_SPEED
+        };
+        sprite->sheet = SPRITE_ENEMY_FRONT;
+    } else {
+        velocity->value = (Vector2){ 0, speed };
+        sprite->sheet = SPRITE_ENEMY;
+        if (kind == ENEMY_CHASER) {
+            *(Steering *)GetComponent(world, enemy, COMPONENT_STEERING) = (Steering){ .maxSpeed = speed, .maxForce = 0.15f };
+        }
+    }
+    return true;
+}
+
+void SpawnWave(World *world, Rng *rng, int wave, int enemyCount, int difficulty, const GameConfig *config) {
+    DespawnMatching(world, HAS_TRANSFORM | HAS_HEALTH | HAS_ENEMY, 0);
+
+    if (wave == 5) {
+        Entity boss = SpawnEntity(world, ARCHETYPE_BOSS);
+        if (boss == ECS_INVALID_ENTITY) return;
+
+        ((Transform *)GetComponent(world, boss, COMPONENT_TRANSFORM))->rect = (Rectangle){ config->screenWidth / 2 - BOSS_SIZE / 2, 50, BOSS_SIZE, BOSS_SIZE };
+        ((Velocity *)GetComponent(world, boss, COMPONENT_VELOCITY))->value = (Vector2){ difficulty, 0 };
+        *(Health *)GetComponent(world, boss, COMPONENT_HEALTH) = (Health){ 50, 50 };
+        *(Enemy *)GetComponent(world, boss, COMPONENT_ENEMY) = (Enemy){ .contactDamage = 0, .scoreValue = 10 };
+        *(Emitter *)GetComponent(world, boss, COMPONENT_EMITTER) = CreateEmitter(bossPattern, BOSS_BULLET_DAMAGE);
+        Sprite *sprite = GetComponent(world, boss, COMPONENT_SPRITE);
+        sprite->sheet = SPRITE_ENEMY_FRONT;
+        sprite->tint = WHITE;
+        return;
+    }
+
+    for (int i = 0; i < enemyCount && i < config->maxEnemies; i++) {
+        Rectangle rect = RollEnemyRect(rng, config);
+        bool shooter = (wave >= 3 && GetRngValue(rng, 0, 4) == 0);
+        // From wave 2 a quarter of the others hunt the submarine instead of patrolling
+        bool chaser = (!shooter && wave >= 2 && GetRngValue(rng, 0, 3) == 0);
+
+        EnemyKind kind = shooter ? ENEMY_SHOOTER : (chaser ? ENEMY_CHASER : ENEMY_PATROLLER);
+        if (!SpawnEnemy(world, rng, kind, rect, wave, difficulty, config)) break;
+    }
+
+    printf("Wave %d: Spawned %d enemies\n", wave, enemyCount);
+}
+
+void SpawnWaveMix(World *world, Rng *rng, WaveMix mix, const GameConfig *config) {
+    DespawnMatching(world, HAS_TRANSFORM | HAS_HEALTH | HAS_ENEMY, 0);
+
+    int counts[] = { [ENEMY_PATROLLER] = mix.patrollers, [ENEMY_CHASER] = mix.chasers, [ENEMY_SHOOTER] = mix.shooters };
+    for (int kind = ENEMY_PATROLLER; kind <= ENEMY_SHOOTER; kind++) {
+        for (int i = 0; i < counts[kind]; i++) {
+            if (!SpawnEnemy(world, rng, kind, RollEnemyRect(rng, config), mix.health, mix.speed, config)) return;
+        }
+    }
+}
+
+void PlayerControlSystem(World *world, const PlayerInput *inputs, const RunStats *stats, const GameConfig *config, float deltaTime) {
+    Archetype *matches[ECS_MAX_ARCHETYPES];
+    int matchCount = QueryArchetypes(world, HAS_TRANSFORM | HAS_HEALTH | HAS_PLAYER | HAS_SPRITE, 0, matches, ECS_MAX_ARCHETYPES);
+
+    for (int m = 0; m < matchCount; m++) {
+        Archetype *archetype = matches[m];
+
+        // Firing spawns into another archetype, so this one's columns stay put
+        for (int i = 0; i < archetype->count; i++) {
+            Rectangle *rect = &((Transform *)archetype->columns[COMPONENT_TRANSFORM])[i].rect;
+            Health *health = &((Health *)archetype->columns[COMPONENT_HEALTH])[i];
+            Player *state = &((Player *)archetype->columns[COMPONENT_PLAYER])[i];
+            Sprite *sprite = &((Sprite *)archetype->columns[COMPONENT_SPRITE])[i];
+            PlayerInput input = inputs[state->slot];
+
+            Vector2 start = { rect->x, rect->y };
+            state->motion = (Vector2){ 0, 0 };
+
+            // A downed submarine fades and sits out until it is healed
+            sprite->tint = Fade(sprite->tint, (health->current > 0) ? 1.0f : 0.4f);
+            if (health->current <= 0) continue;
+
+            if (input.moveX < 0) sprite->flipX = true;
+            if (input.moveX > 0) sprite->flipX = false;
+
+            if (input.moveY < 0 && rect->y > 0) {
+                rect->y -= state->speed * deltaTime;
+            }
+            if (input.moveY > 0 && rect->y + rect->height < config->screenHeight) {
+                rect->y += state->speed * deltaTime;
+            }
+            if (input.moveX < 0 && rect->x > 0) {
+                rect->x -= state->speed * deltaTime;
+            }
+            if (input.moveX > 0 && rect->x + rect->width < config->screenWidth) {
+                rect->x += state->speed * deltaTime;
+            }
+
+            // Speed boost drains energy
+            bool boostRight = input.moveX > 0 && rect->x + rect->width < config->screenWidth;
+            bool boostLeft = input.moveX < 0 && rect->x > 0;
+            if ((input.buttons & INPUT_BOOST) && (boostRight || boostLeft) && state->energy > 0) {
+                rect->x += (boostRight ? 1 : -1) * (state->speed + 5) * deltaTime;
+                state->energy -= stats->boostEnergyCost;
+            }
+
+            state->motion = (Vector2){ rect->x - start.x, rect->y - start.y };
+
+            // Shooting bullets; the special attack waits out its cooldown
+            Entity self = archetype->entities[i];
+            state->specialTimer -= deltaTime;
+            if (input.buttons & INPUT_FIRE) {
+                SpawnPlayerBullet(world, self, false);
+            }
+            if ((input.buttons & INPUT_SPECIAL) && state->specialTimer <= 0 && SpawnPlayerBullet(world, self, true)) {
+                state->specialTimer = stats->specialCooldown;
+            }
+        }
+    }
+}
+
+static Vector2 ClampLength(Vector2 v, float maxLength) {
+    float length = sqrtf(v.x * v.x + v.y * v.y);
+    if (length <= maxLength || length == 0.0f) return v;
+    return (Vector2){ v.x * maxLength / length, v.y * maxLength / length };
+}
+
+void SteeringSystem(World *world, FlowField *flow) {
+    PlayerView players[MAX_PLAYERS];
+    Vector2 targets[MAX_PLAYERS];
+    int playerCount = GatherLivePlayers(world, players);
+    for (int p = 0; p < playerCount; p++) {
+        targets[p] = players[p].center;
+    }
+
+    // Only chasers read the field, so waves without them skip the rebuild
+    Archetype *chasers[ECS_MAX_ARCHETYPES];
+    int chaserCount = QueryArchetypes(world, HAS_TRANSFORM | HAS_VELOCITY | HAS_STEERING, 0, chasers, ECS_MAX_ARCHETYPES);
+    if (chaserCount == 0) return;
+    UpdateFlowField(flow, targets, playerCount);
+
+    // Bucket every enemy centre by flow cell (counting sort) so separation only
+    // looks at neighbouring cells instead of every other enemy
+    Archetype *others[ECS_MAX_ARCHETYPES];
+    int otherCount = QueryArchetypes(world, HAS_TRANSFORM | HAS_HEALTH | HAS_ENEMY, 0, others, ECS_MAX_ARCHETYPES);
+    BeginFlowPoints(flow);
+    for (int o = 0; o < otherCount; o++) {
+        Transform *transforms = others[o]->columns[COMPONENT_TRANSFORM];
+        for (int i = 0; i < others[o]->count; i++) {
+            Rectangle rect = transforms[i].rect;
+            AddFlowPoint(flow, (Vector2){ rect.x + rect.width / 2, rect.y + rect.height / 2 });
+        }
+    }
+    SortFlowPoints(flow);
+
+    // How many cells out a neighbour within the separation radius can be
+    int reach = (int)ceilf(SEPARATION_RADIUS / flow->cellSize);
+
+    for (int m = 0; m < chaserCount; m++) {
+        Archetype *archetype = chasers[m];
+        Transform *transforms = archetype->columns[COMPONENT_TRANSFORM];
+        Velocity *velocities = archetype->columns[COMPONENT_VELOCITY];
+        Steering *steerings = archetype->columns[COMPONENT_STEERING];
+
+        for (int i = 0; i < archetype->count; i++) {
+            Rectangle rect = transforms[i].rect;
+            Vector2 center = { rect.x + rect.width / 2, rect.y + rect.height / 2 };
+            Steering steering = steerings[i];
+
+            Vector2 flowDirection = SampleFlowField(flow, center);
+            Vector2 desired = { flowDirection.x * steering.maxSpeed, flowDirection.y * steering.maxSpeed };
+
+            // Push away from close neighbours, harder the closer they are
+            Vector2 separation = { 0, 0 };
+            int cell = GetFlowCell(flow, center);
+            int cx = cell % flow->columns;
+            int cy = cell / flow->columns;
+            for (int y = cy - reach; y <= cy + reach; y++) {
+                for (int x = cx - reach; x <= cx + reach; x++) {
+                    if (x < 0 || y < 0 || x >= flow->columns || y >= flow->rows) continue;
+                    int c = y * flow->columns + x;
+                    for (int k = flow->cellStart[c]; k < flow->cellStart[c + 1]; k++) {
+                        float dx = center.x - flow->sortedPoints[k].x;
+                        float dy = center.y - flow->sortedPoints[k].y;
+                        float distanceSq = dx * dx + dy * dy;
+                        // Skips itself (distance zero) as well as anything out of range
+                        if (distanceSq < 0.01f || distanceSq > SEPARATION_RADIUS * SEPARATION_RADIUS) continue;
+                        float distance = sqrtf(distanceSq);
+                        float push = (SEPARATION_RADIUS - distance) / SEPARATION_RADIUS;
+                        separation.x += dx / distance * push;
+                        separation.y += dy / distance * push;
+                    }
+                }
+            }
+            desired.x += separation.x * SEPARATION_WEIGHT * steering.maxSpeed;
+            desired.y += separation.y * SEPARATION_WEIGHT * steering.maxSpeed;
+            desired = ClampLength(desired, steering.maxSpeed);
+
+            Vector2 force = ClampLength((Vector2){ desired.x - velocities[i].value.x, desired.y - velocities[i].value.y }, steering.maxForce);
+            velocities[i].value.x += force.x;
+            velocities[i].value.y += force.y;
+        }
+    }
+}
+
+void MovementSystem(World *world, const GameConfig *config) {
+    Archetype *matches[ECS_MAX_ARCHETYPES];
+    int matchCount = QueryArchetypes(world, HAS_TRANSFORM | HAS_VELOCITY, 0, matches, ECS_MAX_ARCHETYPES);
+
+    for (int m = 0; m < matchCount; m++) {
+        Archetype *archetype = matches[m];
+        Transform *transforms = archetype->columns[COMPONENT_TRANSFORM];
+        Velocity *velocities = archetype->columns[COMPONENT_VELOCITY];
+        bool projectiles = (archetype->mask & HAS_PROJECTILE) != 0;
+
+        for (int i = archetype->count - 1; i >= 0; i--) {
+            Rectangle *rect = &transforms[i].rect;
+            Vector2 *velocity = &velocities[i].value;
+
+            // Bounce off the screen edges before moving, so the velocity is exactly
+            // this frame's displacement when projectiles are swept against it
+            if (!projectiles) {
+                if ((rect->x <= 0 && velocity->x < 0) || (rect->x + rect->width >= config->screenWidth && velocity->x > 0)) {
+                    velocity->x = -velocity->x;
+                }
+                if ((rect->y <= 0 && velocity->y < 0) || (rect->y + rect->height >= config->screenHeight && velocity->y > 0)) {
+                    velocity->y = -velocity->y;
+                }
+            }
+
+            rect->x += velocity->x;
+            rect->y += velocity->y;
+
+            // Projectiles are kept until fully off screen so their last step is still swept
+            if (projectiles && (rect->y + rect->height < 0 || rect->y > config->screenHeight ||
+                                rect->x + rect->width < 0 || rect->x > config->screenWidth)) {
+                DespawnEntity(world, archetype->entities[i]);
+            }
+        }
+    }
+}
+
+void CavernSystem(World *world, BulletField *bullets, TileMap *map, CavernState *cavern, const GameConfig *config, float deltaTime) {
+    float previousTop = cavern->top;
+    cavern->top = fmaxf(cavern->top - config->cavernScrollSpeed * deltaTime, 0.0f);
+    float scroll = previousTop - cavern->top;
+    StreamTileMap(map, cavern->seed, cavern->rows, cavern->top);
+
+    // In level space the rock stands still and the screen, with everything on it, rises by
+    // scroll. Each submarine moves from last tick's spot one axis at a time, up to the rock.
+    Archetype *matches[ECS_MAX_ARCHETYPES];
+    int matchCount = QueryArchetypes(world, HAS_TRANSFORM | HAS_HEALTH | HAS_PLAYER, 0, matches, ECS_MAX_ARCHETYPES);
+    for (int m = 0; m < matchCount; m++) {
+        Archetype *archetype = matches[m];
+        for (int i = 0; i < archetype->count; i++) {
+            Rectangle *rect = &((Transform *)archetype->columns[COMPONENT_TRANSFORM])[i].rect;
+            Health *health = &((Health *)archetype->columns[COMPONENT_HEALTH])[i];
+            Player *state = &((Player *)archetype->columns[COMPONENT_PLAYER])[i];
+
+            Vector2 start = { rect->x - state->motion.x, rect->y - state->motion.y };
+            Rectangle level = { start.x, start.y + previousTop, rect->width, rect->height };
+            level.x += MoveAcrossTiles(map, level, state->motion.x, false);
+            level.y += MoveAcrossTiles(map, level, state->motion.y - scroll, true);
+            rect->x = level.x;
+            rect->y = level.y - cavern->top;
+
+            if (rect->y + rect->height > config->screenHeight) {
+                rect->y = config->screenHeight - rect->height;
+                if (health->current > 0) health->current -= CRUSH_DAMAGE;
+            }
+            state->motion = (Vector2){ rect->x - start.x, rect->y - start.y };
+        }
+    }
+
+    // Shots whose step crossed rock, tested over the box the step sweeps in level space
+    matchCount = QueryArchetypes(world, HAS_TRANSFORM | HAS_VELOCITY | HAS_PROJECTILE, 0, matches, ECS_MAX_ARCHETYPES);
+    for (int m = 0; m < matchCount; m++) {
+        Archetype *archetype = matches[m];
+        Transform *transforms = archetype->columns[COMPONENT_TRANSFORM];
+        Velocity *velocities = archetype->columns[COMPONENT_VELOCITY];
+        for (int i = archetype->count - 1; i >= 0; i--) {
+            Rectangle rect = transforms[i].rect;
+            Vector2 velocity = velocities[i].value;
+            Rectangle path = {
+                rect.x - fmaxf(velocity.x, 0.0f),
+                rect.y + cavern->top - fmaxf(velocity.y - scroll, 0.0f),
+                rect.width + fabsf(velocity.x),
+                rect.height + fabsf(velocity.y - scroll)
+            };
+            if (IsTileMapSolid(map, path)) DespawnEntity(world, archetype->entities[i]);
+        }
+    }
+
+    // Enemy bullets move later in the tick, so they are tested where they are
+    for (int i = bullets->count - 1; i >= 0; i--) {
+        Rectangle rect = { bullets->x[i], bullets->y[i] + cavern->top, bullets->width[i], bullets->height[i] };
+        if (IsTileMapSolid(map, rect)) RemoveBullet(bullets, i);
+    }
+}
+
+void ShooterSystem(World *world, BulletField *bullets, const GameConfig *config, float deltaTime) {
+    Archetype *matches[ECS_MAX_ARCHETYPES];
+    int matchCount = QueryArchetypes(world, HAS_TRANSFORM | HAS_SHOOTER, 0, matches, ECS_MAX_ARCHETYPES);
+
+    for (int m = 0; m < matchCount; m++) {
+        Archetype *archetype = matches[m];
+        Transform *transforms = archetype->columns[COMPONENT_TRANSFORM];
+        Shooter *shooters = archetype->columns[COMPONENT_SHOOTER];
+
+        for (int i = 0; i < archetype->count; i++) {
+            shooters[i].timer -= deltaTime;
+            // Regular shooters share a small budget; a shot stays ready until a slot frees up
+            if (shooters[i].timer <= 0 && bullets->count < config->maxEnemyBullets) {
+                Rectangle from = transforms[i].rect;
+                Rectangle rect = { from.x + from.width / 2, from.y + from.height, shooters[i].bulletSize.x, shooters[i].bulletSize.y };
+                SpawnBullet(bullets, rect, (Vector2){ 0, shooters[i].bulletSpeed }, ORANGE, ENEMY_BULLET_DAMAGE);
+                shooters[i].timer = shooters[i].cooldown;
+            }
+        }
+    }
+}
+
+void EmitterSystem(World *world, BulletField *bullets) {
+    PlayerView players[MAX_PLAYERS];
+    int playerCount = GatherLivePlayers(world, players);
+
+    Archetype *matches[ECS_MAX_ARCHETYPES];
+    int matchCount = QueryArchetypes(world, HAS_TRANSFORM | HAS_EMITTER, 0, matches, ECS_MAX_ARCHETYPES);
+
+    for (int m = 0; m < matchCount; m++) {
+        Archetype *archetype = matches[m];
+        Transform *transforms = archetype->columns[COMPONENT_TRANSFORM];
+        Emitter *emitters = archetype->columns[COMPONENT_EMITTER];
+
+        for (int i = 0; i < archetype->count; i++) {
+            Rectangle rect = transforms[i].rect;
+            Vector2 origin = { rect.x + rect.width / 2, rect.y + rect.height / 2 };
+
+            // Aimed shots go for the nearest submarine
+            Vector2 target = { origin.x, origin.y + 1 };
+            float nearest = 0.0f;
+            for (int p = 0; p < playerCount; p++) {
+                float dx = players[p].center.x - origin.x;
+                float dy = players[p].center.y - origin.y;
+                if (p == 0 || dx * dx + dy * dy < nearest) {
+                    nearest = dx * dx + dy * dy;
+                    target = players[p].center;
+                }
+            }
+            RunEmitter(&emitters[i], bullets, origin, target);
+        }
+    }
+}
+
+void EnemyBulletSystem(World *world, BulletField *bullets, const SpriteMasks *masks, EventQueue *events, const GameConfig *config) {
+    UpdateBulletField(bullets, (Rectangle){ 0, 0, config->screenWidth, config->screenHeight });
+
+    PlayerView players[MAX_PLAYERS];
+    int playerCount = GatherLivePlayers(world, players);
+    for (int p = 0; p < playerCount; p++) {
+        Rectangle body = players[p].body;
+        const BitMask *mask = GetSpriteMask(masks, players[p].sprite, body);
+        int damage = CollideBulletField(bullets, players[p].hitbox, players[p].state->motion,
+            mask, (Vector2){ floorf(body.x), floorf(body.y) });
+        if (damage == 0) continue;
+        players[p].health->current -= damage;
+        PushEvent(events, (GameEvent){ EVENT_HIT, (unsigned char)players[p].state->slot, 0, (short)damage, players[p].center });
+    }
+}
+
+void ContactSystem(World *world, const SpriteMasks *masks, EventQueue *events) {
+    PlayerView players[MAX_PLAYERS];
+    int playerCount = GatherLivePlayers(world, players);
+
+    Archetype *matches[ECS_MAX_ARCHETYPES];
+    int matchCount = QueryArchetypes(world, HAS_TRANSFORM | HAS_ENEMY, 0, matches, ECS_MAX_ARCHETYPES);
+
+    for (int m = 0; m < matchCount; m++) {
+        Archetype *archetype = matches[m];
+        Transform *transforms = archetype->columns[COMPONENT_TRANSFORM];
+        Enemy *enemies = archetype->columns[COMPONENT_ENEMY];
+        Sprite *sprites = archetype->columns[COMPONENT_SPRITE];
+        bool boss = (archetype->mask & HAS_BOSS) != 0;
+
+        for (int i = archetype->count - 1; i >= 0; i--) {
+            for (int p = 0; p < playerCount; p++) {
+                // Gathered before the loop; an earlier contact this tick may have sunk it
+                if (players[p].health->current <= 0) continue;
+                if (!CheckCollisionRecs(players[p].hitbox, transforms[i].rect)) continue;
+                if (!TouchesPlayer(&players[p], masks, (sprites != NULL) ? &sprites[i] : NULL, transforms[i].rect)) continue;
+
+                // Touching the boss is fatal and the boss stays
+                Health *health = players[p].health;
+                int damage = boss ? health->current : enemies[i].contactDamage;
+                health->current -= damage;
+                PushEvent(events, (GameEvent){ EVENT_HIT, (unsigned char)players[p].state->slot, boss ? EVENT_FLAG_BOSS : 0, (short)damage, players[p].center });
+                if (!boss) {
+                    DespawnEntity(world, archetype->entities[i]);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Targets one projectile reaches this frame, earliest first
+typedef struct PendingHits {
+    Entity projectile;
+    int count;
+    Entity targets[PROJECTILE_MAX_PIERCE];
+    float times[PROJECTILE_MAX_PIERCE];
+} PendingHits;
+
+// Sweeps one projectile against every enemy it has not hit yet and keeps the
+// first pierce impacts. Reads the world only, so projectiles can be swept in any order.
+// The generation in a handle keeps a newer enemy in the same slot from matching
+static bool HasHit(const Projectile *projectile, Entity enemy) {
+    for (int i = 0; i < projectile->hitCount; i++) {
+        if (projectile->hits[i] == enemy) return true;
+    }
+    return false;
+}
+
+static void FindProjectileHits(Archetype **targets, int targetCount, Rectangle rect, Vector2 velocity,
+                               const Projectile *projectile, PendingHits *pending) {
+    int limit = (projectile->pierce < PROJECTILE_MAX_PIERCE) ? projectile->pierce : PROJECTILE_MAX_PIERCE;
+    Rectangle start = { rect.x - velocity.x, rect.y - velocity.y, rect.width, rect.height };
+    pending->count = 0;
+
+    for (int t = 0; t < targetCount; t++) {
+        Archetype *target = targets[t];
+        Transform *transforms = target->columns[COMPONENT_TRANSFORM];
+        Velocity *velocities = target->columns[COMPONENT_VELOCITY];
+
+        for (int i = 0; i < target->count; i++) {
+            if (HasHit(projectile, target->entities[i])) continue;
+
+            // Relative to the enemy, which also moved this frame
+            Vector2 targetVelocity = velocities[i].value;
+            Rectangle targetStart = transforms[i].rect;
+            targetStart.x -= targetVelocity.x;
+            targetStart.y -= targetVelocity.y;
+            Vector2 delta = { velocity.x - targetVelocity.x, velocity.y - targetVelocity.y };
+
+            float time;
+            if (!SweepRects(start, delta, targetStart, &time)) continue;
+            if (pending->count == limit && time >= pending->times[limit - 1]) continue;
+
+            // Insertion into the short list sorted by time of impact
+            int slot = (pending->count < limit) ? pending->count++ : limit - 1;
+            while (slot > 0 && pending->times[slot - 1] > time) {
+                pending->targets[slot] = pending->targets[slot - 1];
+                pending->times[slot] = pending->times[slot - 1];
+                slot--;
+            }
+            pending->targets[slot] = target->entities[i];
+            pending->times[slot] = time;
+        }
+    }
+}
+
+void ProjectileSystem(World *world, EventQueue *events, Arena *scratch) {
+    Archetype *targets[ECS_MAX_ARCHETYPES];
+    Archetype *bullets[ECS_MAX_ARCHETYPES];
+    int targetCount = QueryArchetypes(world, HAS_TRANSFORM | HAS_VELOCITY | HAS_HEALTH | HAS_ENEMY, 0, targets, ECS_MAX_ARCHETYPES);
+    int bulletCount = QueryArchetypes(world, HAS_TRANSFORM | HAS_VELOCITY | HAS_PROJECTILE, HAS_ENEMY, bullets, ECS_MAX_ARCHETYPES);
+
+    for (int b = 0; b < bulletCount; b++) {
+        Archetype *bullet = bullets[b];
+        int count = bullet->count;
+        if (count == 0) continue;
+
+        // Broadphase: every projectile finds its hits against the same, unmodified world.
+        // A refused list shows up in the arena's refusal count; those shots fly on unresolved for a tick.
+        PendingHits *pending = ArenaAlloc(scratch, count * sizeof(PendingHits));
+        if (pending == NULL) continue;
+        Transform *transforms = bullet->columns[COMPONENT_TRANSFORM];
+        Velocity *velocities = bullet->columns[COMPONENT_VELOCITY];
+        Projectile *projectiles = bullet->columns[COMPONENT_PROJECTILE];
+        for (int j = 0; j < count; j++) {
+            pending[j].projectile = bullet->entities[j];
+            FindProjectileHits(targets, targetCount, transforms[j].rect, velocities[j].value, &projectiles[j], &pending[j]);
+        }
+
+        // Resolve in a fixed order: projectiles by row, each projectile's targets by time of impact
+        for (int j = 0; j < count; j++) {
+            if (pending[j].count == 0) continue;
+            Projectile *projectile = GetComponent(world, pending[j].projectile, COMPONENT_PROJECTILE);
+
+            for (int k = 0; k < pending[j].count && projectile->pierce > 0; k++) {
+                Entity target = pending[j].targets[k];
+                // Already destroyed by an earlier projectile this frame
+                if (!IsEntityAlive(world, target)) continue;
+
+                Health *health = GetComponent(world, target, COMPONENT_HEALTH);
+                Enemy *enemy = GetComponent(world, target, COMPONENT_ENEMY);
+                health->current -= projectile->damage;
+                if (projectile->hitCount < PROJECTILE_MAX_PIERCE) projectile->hits[projectile->hitCount++] = target;
+                projectile->pierce--;
+
+                if (health->current <= 0) {
+                    Rectangle rect = ((Transform *)GetComponent(world, target, COMPONENT_TRANSFORM))->rect;
+                    unsigned char flags = HasComponent(world, target, COMPONENT_BOSS) ? EVENT_FLAG_BOSS : 0;
+                    PushEvent(events, (GameEvent){ EVENT_KILL, (unsigned char)projectile->owner, flags, (short)enemy->scoreValue,
+                        { rect.x + rect.width / 2, rect.y + rect.height / 2 } });
+                    DespawnEntity(world, target);
+                }
+            }
+
+            if (projectile->pierce <= 0) {
+                DespawnEntity(world, pending[j].projectile);
+            }
+        }
+    }
+}
+
+void AnimationSystem(World *world, const GameConfig *config, float deltaTime) {
+    Archetype *matches[ECS_MAX_ARCHETYPES];
+    int matchCount = QueryArchetypes(world, HAS_SPRITE, 0, matches, ECS_MAX_ARCHETYPES);
+
+    for (int m = 0; m < matchCount; m++) {
+        Archetype *archetype = matches[m];
+        Sprite *sprites = archetype->columns[COMPONENT_SPRITE];
+        Velocity *velocities = archetype->columns[COMPONENT_VELOCITY];
+
+        for (int i = 0; i < archetype->count; i++) {
+            Sprite *sprite = &sprites[i];
+
+            switch (sprite->sheet) {
+                case SPRITE_ENEMY:
+                case SPRITE_ENEMY_FRONT: {
+                    // Enemies step through their frames as they travel rather than over time
+                    Vector2 velocity = velocities ? velocities[i].value : (Vector2){ 0, 0 };
+                    int frame = (int)(sprite->animDistance / (ENEMY_ANIM_CYCLE / ENEMY_FRAMES));
+                    if (frame >= ENEMY_FRAMES) frame = ENEMY_FRAMES - 1;
+                    bool movingUp = (sprite->sheet == SPRITE_ENEMY && velocity.y < 0);
+                    sprite->frame = frame + (movingUp ? ENEMY_FRAMES : 0);
+
+                    sprite->animDistance += fabsf(velocity.x) + fabsf(velocity.y);
+                    if (sprite->animDistance >= ENEMY_ANIM_CYCLE) sprite->animDistance = 0;
+                } break;
+                case SPRITE_ROCKET:
+                    sprite->frameTime += deltaTime;
+                    if (sprite->frameTime >= ROCKET_FRAME_TIME) {
+                        sprite->frameTime = 0.0f;
+                        sprite->frame = (sprite->frame + 1) % ROCKET_FRAMES;
+                    }
+                    break;
+                case SPRITE_SUBMARINE:
+                    sprite->frameTime += deltaTime;
+                    if (sprite->frameTime >= config->frameSpeed) {
+                        sprite->frameTime = 0.0f;
+                        sprite->frame = (sprite->frame + 1) % config->frameCount;
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+void RenderSystem(World *world, const SpriteAtlas *atlas, DrawList *list) {
+    Archetype *matches[ECS_MAX_ARCHETYPES];
+    int matchCount = QueryArchetypes(world, HAS_TRANSFORM | HAS_SPRITE, 0, matches, ECS_MAX_ARCHETYPES);
+
+    for (int m = 0; m < matchCount; m++) {
+        Archetype *archetype = matches[m];
+        Transform *transforms = archetype->columns[COMPONENT_TRANSFORM];
+        Sprite *sprites = archetype->columns[COMPONENT_SPRITE];
+
+        for (int i = 0; i < archetype->count; i++) {
+            Rectangle rect = transforms[i].rect;
+            const Sprite *sprite = &sprites[i];
+
+            switch (sprite->sheet) {
+                case SPRITE_SUBMARINE: {
+                    Texture2D texture = atlas->submarine;
+                    Rectangle source = { 0, 0, sprite->flipX ? -texture.width : texture.width, texture.height };
+                    SubmitSprite(list, LAYER_PLAYERS, texture, source, rect, 0.0f, sprite->tint);
+                } break;
+                case SPRITE_ENEMY:
+                case SPRITE_ENEMY_FRONT: {
+                    Texture2D texture = atlas->enemy[sprite->frame];
+                    SubmitSprite(list, LAYER_ENEMIES, texture, (Rectangle){ 0, 0, texture.width, texture.height }, rect, 0.0f, sprite->tint);
+                } break;
+                case SPRITE_ROCKET: {
+                    // Rocket art points right; it is drawn at half size rotated to face up
+                    Texture2D texture = atlas->rocket[sprite->frame];
+                    Rectangle dest = { rect.x, rect.y, rect.width * 0.5f, rect.height * 0.5f };
+                    SubmitSprite(list, LAYER_PROJECTILES, texture, (Rectangle){ 0, 0, texture.width, texture.height }, dest, 270.0f, sprite->tint);
+                } break;
+                case SPRITE_SOLID:
+                    SubmitRect(list, LAYER_PROJECTILES, rect, sprite->tint);
+                    break;
+            }
+        }
+
+        // Health bar above the boss
+        if (archetype->mask & HAS_BOSS) {
+            Health *healths = archetype->columns[COMPONENT_HEALTH];
+            for (int i = 0; i < archetype->count; i++) {
+                float healthBarWidth = 20;
+                float healthBarHeight = 20;
+                float healthBarX = transforms[i].rect.x + (transforms[i].rect.width - healthBarWidth) / 2;
+                float healthBarY = transforms[i].rect.y - healthBarHeight - 5;
+
+                SubmitRect(list, LAYER_OVERLAY, (Rectangle){ healthBarX, healthBarY, healthBarWidth, healthBarHeight }, DARKGRAY);
+                SubmitRect(list, LAYER_OVERLAY, (Rectangle){ healthBarX, healthBarY, healthBarWidth * healths[i].current / healths[i].max, healthBarHeight }, GREEN);
+            }
+        }
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef SYSTEMS_H
+#define SYSTEMS_H
+
+#include "raylib.h"
+#include "ecs.h"
+#include "config.h"
+#include "bullets.h"
+#include "flowfield.h"
+#include "input.h"
+#include "rng.h"
+#include "drawlist.h"
+#include "arena.h"
+#include "director.h"
+#include "bitmask.h"
+#include "tilemap.h"
+#include "events.h"
+#include "buffs.h"
+
+#define MAX_PLAYERS 2
+#define MAX_PLAYER_BULLETS 10    // Per player
+#define ENEMY_FRAMES 3           // Per facing; back views follow the front views in SpriteAtlas.enemy
+#define ROCKET_FRAMES 5
+
+// Archetype masks for everything the game spawns
+#define ARCHETYPE_PLAYER (HAS_TRANSFORM | HAS_HEALTH | HAS_PLAYER | HAS_SPRITE)
+#define ARCHETYPE_PLAYER_BULLET (HAS_TRANSFORM | HAS_VELOCITY | HAS_PROJECTILE | HAS_SPRITE)
+#define ARCHETYPE_ENEMY (HAS_TRANSFORM | HAS_VELOCITY | HAS_HEALTH | HAS_ENEMY | HAS_SPRITE)
+#define ARCHETYPE_SHOOTER (ARCHETYPE_ENEMY | HAS_SHOOTER)
+#define ARCHETYPE_CHASER (ARCHETYPE_ENEMY | HAS_STEERING)
+#define ARCHETYPE_BOSS (ARCHETYPE_ENEMY | HAS_EMITTER | HAS_BOSS)
+
+typedef struct SpriteAtlas {
+    Texture2D submarine;
+    Texture2D enemy[ENEMY_FRAMES * 2];
+    Texture2D rocket[ROCKET_FRAMES];
+} SpriteAtlas;
+
+// Solid pixels of the sprites that touch a submarine, at the size they are spawned
+typedef struct SpriteMasks {
+    BitMask submarine[2];                    // Facing right, then flipped
+    BitMask enemy[ENEMY_FRAMES * 2];         // Same frames as SpriteAtlas.enemy
+    BitMask boss[ENEMY_FRAMES];              // Front views at the boss's size
+} SpriteMasks;
+
+// Builds the masks from the images the atlas was made from; enemy holds ENEMY_FRAMES * 2
+SpriteMasks LoadSpriteMasks(Image submarine, const Image *enemy, const GameConfig *config);
+void UnloadSpriteMasks(SpriteMasks masks);
+// Most enemies any wave can field: the tuned cap, or the largest endless plan
+int GetEnemyCeiling(const GameConfig *config);
+// Entity table size that holds every submarine, its bullets, the boss and a full wave
+int GetWorldCapacity(const GameConfig *config);
+// Sizes every archetype's storage up front; spawning never allocates, so
+// nothing past this can spawn
+void ReserveWorld(World *world, const GameConfig *config);
+// Re-applies tuned values to a running world: grows the entity table and
+// reservations to the new ceiling and retimes live shooters. Call between ticks.
+void RetuneWorld(World *world, const GameConfig *config);
+// Slot picks the input that drives the submarine and where it starts
+Entity SpawnPlayer(World *world, const GameConfig *config, int slot);
+void ResetPlayer(World *world, Entity player);
+bool SpawnPlayerBullet(World *world, Entity player, bool heavy);
+// Replaces the current enemies with the given wave; wave 5 is the boss.
+// Every random roll comes from rng, so the same seed spawns the same wave.
+void SpawnWave(World *world, Rng *rng, int wave, int enemyCount, int difficulty, const GameConfig *config);
+// Replaces the current enemies with exactly the kinds in mix, at random positions
+void SpawnWaveMix(World *world, Rng *rng, WaveMix mix, const GameConfig *config);
+// Submarines still in the fight; a downed one (no health left) stays in the world but sits out
+int CountLivePlayers(World *world);
+
+// The systems below read no devices, clocks or global random state, so a tick
+// depends only on the world and the inputs it is given
+// Moves each submarine by inputs[slot] and fires its weapons
+void PlayerControlSystem(World *world, const PlayerInput *inputs, const RunStats *stats, const GameConfig *config, float deltaTime);
+// Rebuilds the flow field towards the live submarines, then turns chasers along it
+void SteeringSystem(World *world, FlowField *flow);
+void MovementSystem(World *world, const GameConfig *config);
+// Scrolls the cavern one step, keeps the submarines out of its rock (rock that
+// pushes one off the bottom of the screen crushes it) and stops shots that hit it
+void CavernSystem(World *world, BulletField *bullets, TileMap *map, CavernState *cavern, const GameConfig *config, float deltaTime);
+// Enemy fire goes into the bullet field: shooters aim straight down, emitters run patterns
+void ShooterSystem(World *world, BulletField *bullets, const GameConfig *config, float deltaTime);
+void EmitterSystem(World *world, BulletField *bullets);
+// Hits on a submarine need overlapping rectangles, then, where masks is given,
+// overlapping solid pixels inside its hitbox. The damage is dealt on the spot,
+// so later systems this tick see who is down, and each hit is also queued.
+void EnemyBulletSystem(World *world, BulletField *bullets, const SpriteMasks *masks, EventQueue *events, const GameConfig *config);
+void ContactSystem(World *world, const SpriteMasks *masks, EventQueue *events);
+// Damages and destroys the enemies the player's projectiles reach and queues
+// a kill for each; what a kill earns is left to the queue's readers
+void ProjectileSystem(World *world, EventQueue *events, Arena *scratch);
+void AnimationSystem(World *world, const GameConfig *config, float deltaTime);
+// Submits every sprite to the draw list; nothing is drawn until it is flushed
+void RenderSystem(World *world, const SpriteAtlas *atlas, DrawList *list);
+
+#endif
@@ -0,0 +1,186 @@
+#include "text.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Layout of a single glyph the same way DrawTextEx places it
+static TextQuad LayoutGlyph(const TextFace *face, int index, float penX, float penY) {
+    Font font = face->font;
+    float scale = face->size / font.baseSize;
+    float padding = font.glyphPadding;
+    Rectangle rec = font.recs[index];
+
+    return (TextQuad){
+        .source = { rec.x - padding, rec.y - padding, rec.width + 2 * padding, rec.height + 2 * padding },
+        .dest = {
+            penX + (font.glyphs[index].offsetX - padding) * scale,
+            penY + (font.glyphs[index].offsetY - padding) * scale,
+            (rec.width + 2 * padding) * scale,
+            (rec.height + 2 * padding) * scale
+        }
+    };
+}
+
+static float GlyphAdvance(const TextFace *face, int index) {
+    Font font = face->font;
+    float scale = face->size / font.baseSize;
+    float advance = (font.glyphs[index].advanceX == 0) ? font.recs[index].width : font.glyphs[index].advanceX;
+    return advance * scale + face->spacing;
+}
+
+TextSystem *LoadTextSystem(const char *customFontPath, const int *bakedSizes, int bakedCount) {
+    TextSystem *text = calloc(1, sizeof(TextSystem));
+
+    if (bakedCount > TEXT_MAX_BAKED_SIZES) bakedCount = TEXT_MAX_BAKED_SIZES;
+    for (int i = 0; i < bakedCount; i++) {
+        text->baked[i] = LoadFontEx(customFontPath, bakedSizes[i], NULL, 0);
+        SetTextureFilter(text->baked[i].texture, TEXTURE_FILTER_BILINEAR);
+    }
+    text->bakedCount = bakedCount;
+
+    return text;
+}
+
+void UnloadTextSystem(TextSystem *text) {
+    for (int i = 0; i < text->bakedCount; i++) {
+        UnloadFont(text->baked[i]);
+    }
+    free(text);
+}
+
+int GetTextFace(TextSystem *text, bool custom, float size, float spacing) {
+    for (int i = 0; i < text->faceCount; i++) {
+        TextFace *face = &text->faces[i];
+        if (face->custom == custom && face->size == size && face->spacing == spacing) return i;
+    }
+    if (text->faceCount == TEXT_MAX_FACES) return 0;
+
+    TextFace *face = &text->faces[text->faceCount];
+    memset(face, 0, sizeof(TextFace));
+    face->size = size;
+    face->spacing = spacing;
+    face->custom = custom && text->bakedCount > 0;
+    face->font = GetFontDefault();
+
+    // Smallest baked atlas that is at least as large as the face, otherwise the largest one
+    if (face->custom) {
+        face->font = text->baked[0];
+        for (int i = 1; i < text->bakedCount; i++) {
+            Font candidate = text->baked[i];
+            bool candidateFits = candidate.baseSize >= size;
+            bool currentFits = face->font.baseSize >= size;
+            if ((candidateFits && (!currentFits || candidate.baseSize < face->font.baseSize)) ||
+                (!candidateFits && !currentFits && candidate.baseSize > face->font.baseSize)) {
+                face->font = candidate;
+            }
+        }
+    }
+
+    // Digit strip used to draw numbers without formatting them into a string first
+    const char digitChars[TEXT_DIGIT_GLYPHS] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '.', '-' };
+    for (int i = 0; i < TEXT_DIGIT_GLYPHS; i++) {
+        int index = GetGlyphIndex(face->font, digitChars[i]);
+        face->digits[i] = LayoutGlyph(face, index, 0, 0);
+        face->digitAdvance[i] = GlyphAdvance(face, index);
+    }
+
+    return text->faceCount++;
+}
+
+static unsigned int HashText(int face, const char *str) {
+    // FNV-1a over the face id and the string bytes
+    unsigned int hash = 2166136261u ^ (unsigned int)face;
+    hash *= 16777619u;
+    for (const unsigned char *c = (const unsigned char *)str; *c; c++) {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static const TextLayout *GetTextLayout(TextSystem *text, int face, const char *str) {
+    unsigned int hash = HashText(face, str);
+    TextLayout *layout = &text->cache[hash % TEXT_CACHE_SLOTS];
+
+    if (layout->hash == hash && layout->face == face && strncmp(layout->text, str, TEXT_MAX_CHARS) == 0) {
+        text->hits++;
+        return layout;
+    }
+    text->misses++;
+
+    // Direct-mapped cache: a miss simply replaces whatever occupied the slot
+    const TextFace *textFace = &text->faces[face];
+    layout->hash = hash;
+    layout->face = face;
+    strncpy(layout->text, str, TEXT_MAX_CHARS - 1);
+    layout->text[TEXT_MAX_CHARS - 1] = '\0';
+    layout->quadCount = 0;
+
+    float penX = 0;
+    float penY = 0;
+    float width = 0;
+    for (const char *c = layout->text; *c; ) {
+        int codepointSize = 0;
+        int codepoint = GetCodepointNext(c, &codepointSize);
+        c += codepointSize;
+
+        if (codepoint == '\n') {
+            if (penX - textFace->spacing > width) width = penX - textFace->spacing;
+            penX = 0;
+            penY += textFace->size + 2;
+            continue;
+        }
+
+        int index = GetGlyphIndex(textFace->font, codepoint);
+        if (codepoint != ' ' && codepoint != '\t') {
+            layout->quads[layout->quadCount++] = LayoutGlyph(textFace, index, penX, penY);
+        }
+        penX += GlyphAdvance(textFace, index);
+    }
+    if (penX - textFace->spacing > width) width = penX - textFace->spacing;
+    layout->size = (Vector2){ width, penY + textFace->size };
+    layout->advance = penX;
+
+    return layout;
+}
+
+Vector2 MeasureCachedText(TextSystem *text, int face, const char *str) {
+    return GetTextLayout(text, face, str)->size;
+}
+
+float DrawCachedText(TextSystem *text, int face, const char *str, Vector2 position, Color color) {
+    const TextLayout *layout = GetTextLayout(text, face, str);
+    Texture2D atlas = text->faces[face].font.texture;
+
+    for (int i = 0; i < layout->quadCount; i++) {
+        Rectangle dest = layout->quads[i].dest;
+        dest.x += position.x;
+        dest.y += position.y;
+        DrawTexturePro(atlas, layout->quads[i].source, dest, (Vector2){ 0, 0 }, 0.0f, color);
+    }
+    return layout->advance;
+}
+
+float DrawTextNumber(TextSystem *text, int face, int value, int decimals, Vector2 position, Color color) {
+    const TextFace *textFace = &text->faces[face];
+
+    // Collect digit indices least significant first, inserting the decimal point
+    int glyphs[16];
+    int count = 0;
+    unsigned int magnitude = (value < 0) ? -(unsigned int)value : (unsigned int)value;
+    do {
+        if (count == decimals && decimals > 0) glyphs[count++] = 10;
+        glyphs[count++] = magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0 || count <= decimals);
+    if (value < 0) glyphs[count++] = 11;
+
+    float penX = position.x;
+    for (int i = count - 1; i >= 0; i--) {
+        TextQuad quad = textFace->digits[glyphs[i]];
+        quad.dest.x += penX;
+        quad.dest.y += position.y;
+        DrawTexturePro(textFace->font.texture, quad.source, quad.dest, (Vector2){ 0, 0 }, 0.0f, color);
+        penX += textFace->digitAdvance[glyphs[i]];
+    }
+    return penX - position.x;
+}
@@ -0,0 +1,58 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+#include "raylib.h"
+
+#define TEXT_MAX_BAKED_SIZES 4
+#define TEXT_MAX_FACES 16
+#define TEXT_CACHE_SLOTS 128
+#define TEXT_MAX_CHARS 48
+#define TEXT_DIGIT_GLYPHS 12     // '0'-'9', '.', '-'
+
+// One glyph of a laid-out string, relative to the string origin
+typedef struct TextQuad {
+    Rectangle source;
+    Rectangle dest;
+} TextQuad;
+
+// Font at a fixed size. Custom faces use the baked atlas closest to their size,
+// so large text is never rasterised small and scaled up.
+typedef struct TextFace {
+    Font font;
+    float size;
+    float spacing;
+    bool custom;
+    TextQuad digits[TEXT_DIGIT_GLYPHS];
+    float digitAdvance[TEXT_DIGIT_GLYPHS];
+} TextFace;
+
+// Cached layout of one string, keyed by face and content
+typedef struct TextLayout {
+    unsigned int hash;
+    int face;
+    char text[TEXT_MAX_CHARS];
+    int quadCount;
+    Vector2 size;
+    float advance;           // Pen movement, including trailing spacing, for chaining draws
+    TextQuad quads[TEXT_MAX_CHARS];
+} TextLayout;
+
+typedef struct TextSystem {
+    Font baked[TEXT_MAX_BAKED_SIZES];        // fonts/Harmonic.ttf rasterised at each requested size
+    int bakedCount;
+    TextFace faces[TEXT_MAX_FACES];
+    int faceCount;
+    TextLayout cache[TEXT_CACHE_SLOTS];
+    unsigned int hits;
+    unsigned int misses;
+} TextSystem;
+
+TextSystem *LoadTextSystem(const char *customFontPath, const int *bakedSizes, int bakedCount);
+void UnloadTextSystem(TextSystem *text);
+int GetTextFace(TextSystem *text, bool custom, float size, float spacing);
+Vector2 MeasureCachedText(TextSystem *text, int face, const char *str);
+// Both draw functions return how far the pen advanced so draws can be chained on one line
+float DrawCachedText(TextSystem *text, int face, const char *str, Vector2 position, Color color);
+float DrawTextNumber(TextSystem *text, int face, int value, int decimals, Vector2 position, Color color);
+
+#endif
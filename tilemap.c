@@ -0,0 +1,223 @@
+#include "tilemap.h"
+#include <stdlib.h>
+#include <math.h>
+
+#define PASSAGE_MIN_COLUMNS 8        // Narrowest the way through gets
+#define WALL_RAMP_ROWS 12            // Rows over which the walls close in after the open ends
+#define BOULDER_CHANCE 53            // One 2x2 boulder cell in this many, where the passage is wide
+#define BOULDER_MARGIN 4             // Columns of water kept on either side of a boulder
+
+static const Color rockColor = { 38, 50, 58, 255 };
+
+static int FloorDiv(int a, int b) {
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+static unsigned int HashTile(unsigned int seed, int x, int y) {
+    unsigned int h = seed ^ ((unsigned int)x * 0x27D4EB2Du) ^ ((unsigned int)y * 0x165667B1u);
+    h ^= h >> 15;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+// Smooth value noise along the level in [0, 1], with a control point every period rows
+static float CavernNoise(unsigned int seed, int row, int period) {
+    int cell = FloorDiv(row, period);
+    float t = (float)(row - cell * period) / period;
+    float a = (HashTile(seed, 0, cell) & 0xFFFF) / 65535.0f;
+    float b = (HashTile(seed, 0, cell + 1) & 0xFFFF) / 65535.0f;
+    t = t * t * (3.0f - 2.0f * t);
+    return a + (b - a) * t;
+}
+
+// Open columns [left, right) of a row. A screen's worth of rows at each end
+// stays open water, then the walls close in towards the wandering passage.
+static bool GetPassage(const TileMap *map, int row, int *left, int *right) {
+    int fromStart = (map->rows - 1 - row) - map->visibleRows;
+    int fromEnd = row - map->visibleRows;
+    int edge = (fromStart < fromEnd) ? fromStart : fromEnd;
+    *left = 0;
+    *right = map->columns;
+    if (edge <= 0 || map->columns < PASSAGE_MIN_COLUMNS + 2) return false;
+
+    float ramp = (edge >= WALL_RAMP_ROWS) ? 1.0f : (float)edge / WALL_RAMP_ROWS;
+    float columns = (float)map->columns;
+    float width = PASSAGE_MIN_COLUMNS + CavernNoise(map->seed ^ 0xA511E9B3u, row, 24) * (columns - 2 - PASSAGE_MIN_COLUMNS);
+    float center = width / 2 + CavernNoise(map->seed ^ 0x63D83595u, row, 40) * (columns - width);
+    width = columns - ramp * (columns - width);
+    center = columns / 2 + ramp * (center - columns / 2);
+
+    *left = (int)floorf(center - width / 2 + 0.5f);
+    if (*left < 0) *left = 0;
+    *right = *left + (int)(width + 0.5f);
+    if (*right > map->columns) *right = map->columns;
+    return ramp == 1.0f;
+}
+
+static TileKind GenerateTile(const TileMap *map, int column, int row) {
+    int left, right;
+    bool walled = GetPassage(map, row, &left, &right);
+    if (column < left || column >= right) return TILE_ROCK;
+    if (!walled) return TILE_WATER;
+
+    // Boulders sit on a 2x2 lattice and only where both of their rows leave room around them
+    int cellX = FloorDiv(column, 2);
+    int cellY = FloorDiv(row, 2);
+    if (HashTile(map->seed ^ 0x2C1B3C6Du, cellX, cellY) % BOULDER_CHANCE != 0) return TILE_WATER;
+    for (int r = cellY * 2; r < cellY * 2 + 2; r++) {
+        if (!GetPassage(map, r, &left, &right)) return TILE_WATER;
+        if (cellX * 2 < left + BOULDER_MARGIN || cellX * 2 + 2 > right - BOULDER_MARGIN) return TILE_WATER;
+    }
+    return TILE_ROCK;
+}
+
+static void FillChunk(TileMap *map, int slot, int chunk) {
+    unsigned char *tiles = &map->tiles[slot * TILE_CHUNK_ROWS * map->columns];
+    for (int r = 0; r < TILE_CHUNK_ROWS; r++) {
+        for (int c = 0; c < map->columns; c++) {
+            tiles[r * map->columns + c] = (unsigned char)GenerateTile(map, c, chunk * TILE_CHUNK_ROWS + r);
+        }
+    }
+    map->slotChunk[slot] = chunk;
+}
+
+TileMap *LoadTileMap(int screenWidth, int screenHeight) {
+    TileMap *map = calloc(1, sizeof(TileMap));
+    if (map == NULL) return NULL;
+
+    map->columns = (screenWidth + TILE_SIZE - 1) / TILE_SIZE;
+    map->visibleRows = (screenHeight + TILE_SIZE - 1) / TILE_SIZE;
+    // The screen's rows can straddle one more chunk than they fill, and one chunk is kept ahead
+    map->slotCount = (map->visibleRows + TILE_CHUNK_ROWS - 1) / TILE_CHUNK_ROWS + 2;
+    map->slotChunk = malloc(map->slotCount * sizeof(int));
+    map->tiles = malloc((size_t)map->slotCount * TILE_CHUNK_ROWS * map->columns);
+    if (map->slotChunk == NULL || map->tiles == NULL) {
+        UnloadTileMap(map);
+        return NULL;
+    }
+    for (int i = 0; i < map->slotCount; i++) {
+        map->slotChunk[i] = -1;
+    }
+    return map;
+}
+
+void UnloadTileMap(TileMap *map) {
+    if (map == NULL) return;
+    free(map->slotChunk);
+    free(map->tiles);
+    free(map);
+}
+
+float GetTileMapStart(const TileMap *map, int rows) {
+    float start = (float)(rows - map->visibleRows) * TILE_SIZE;
+    return (start > 0.0f) ? start : 0.0f;
+}
+
+void StreamTileMap(TileMap *map, unsigned int seed, int rows, float top) {
+    if (seed != map->seed || rows != map->rows) {
+        map->seed = seed;
+        map->rows = rows;
+        for (int i = 0; i < map->slotCount; i++) {
+            map->slotChunk[i] = -1;
+        }
+        map->resident = 0;
+    }
+
+    int topRow = (int)floorf(top / TILE_SIZE);
+    int first = FloorDiv(topRow, TILE_CHUNK_ROWS) - 1;
+    int last = FloorDiv(topRow + map->visibleRows, TILE_CHUNK_ROWS);
+    int lastChunk = FloorDiv(rows - 1, TILE_CHUNK_ROWS);
+    if (first < 0) first = 0;
+    if (last > lastChunk) last = lastChunk;
+
+    // Chunks that scrolled off the bottom, or that a restore jumped away from
+    for (int i = 0; i < map->slotCount; i++) {
+        int chunk = map->slotChunk[i];
+        if (chunk >= 0 && (chunk < first || chunk > last)) {
+            map->slotChunk[i] = -1;
+            map->resident--;
+            map->evicted++;
+        }
+    }
+    for (int chunk = first; chunk <= last; chunk++) {
+        int slot = chunk % map->slotCount;
+        if (map->slotChunk[slot] == chunk) continue;
+        FillChunk(map, slot, chunk);
+        map->resident++;
+        map->streamed++;
+    }
+}
+
+TileKind GetTile(const TileMap *map, int column, int row) {
+    if (column < 0 || column >= map->columns) return TILE_ROCK;
+    if (row < 0 || row >= map->rows) return TILE_WATER;
+
+    int chunk = row / TILE_CHUNK_ROWS;
+    int slot = chunk % map->slotCount;
+    if (map->slotChunk[slot] != chunk) return GenerateTile(map, column, row);
+    return (TileKind)map->tiles[(slot * TILE_CHUNK_ROWS + row - chunk * TILE_CHUNK_ROWS) * map->columns + column];
+}
+
+bool IsTileMapSolid(const TileMap *map, Rectangle rect) {
+    int column0 = (int)floorf(rect.x / TILE_SIZE);
+    int column1 = (int)ceilf((rect.x + rect.width) / TILE_SIZE) - 1;
+    int row0 = (int)floorf(rect.y / TILE_SIZE);
+    int row1 = (int)ceilf((rect.y + rect.height) / TILE_SIZE) - 1;
+    for (int row = row0; row <= row1; row++) {
+        for (int column = column0; column <= column1; column++) {
+            if (GetTile(map, column, row) == TILE_ROCK) return true;
+        }
+    }
+    return false;
+}
+
+float MoveAcrossTiles(const TileMap *map, Rectangle rect, float distance, bool vertical) {
+    if (distance == 0.0f) return 0.0f;
+
+    // Along is the axis of travel, across the one the leading edge spans
+    float start = vertical ? rect.y : rect.x;
+    float size = vertical ? rect.height : rect.width;
+    float acrossStart = vertical ? rect.x : rect.y;
+    float acrossSize = vertical ? rect.width : rect.height;
+    int across0 = (int)floorf(acrossStart / TILE_SIZE);
+    int across1 = (int)ceilf((acrossStart + acrossSize) / TILE_SIZE) - 1;
+
+    // Only the lines the edge moves into are tested, so a rect already touching rock can back out
+    int step = (distance > 0) ? 1 : -1;
+    int from, to;
+    if (distance > 0) {
+        from = (int)ceilf((start + size) / TILE_SIZE);
+        to = (int)ceilf((start + size + distance) / TILE_SIZE) - 1;
+    } else {
+        from = (int)floorf(start / TILE_SIZE) - 1;
+        to = (int)floorf((start + distance) / TILE_SIZE);
+    }
+
+    for (int line = from; (to - line) * step >= 0; line += step) {
+        for (int a = across0; a <= across1; a++) {
+            TileKind tile = vertical ? GetTile(map, a, line) : GetTile(map, line, a);
+            if (tile != TILE_ROCK) continue;
+            return (distance > 0) ? line * TILE_SIZE - (start + size) : (line + 1) * TILE_SIZE - start;
+        }
+    }
+    return distance;
+}
+
+void DrawTileMap(const TileMap *map, float top, DrawList *list) {
+    int row0 = (int)floorf(top / TILE_SIZE);
+    for (int row = row0; row <= row0 + map->visibleRows; row++) {
+        float y = row * TILE_SIZE - top;
+        int runStart = -1;
+        for (int column = 0; column <= map->columns; column++) {
+            bool rock = column < map->columns && GetTile(map, column, row) == TILE_ROCK;
+            if (rock && runStart < 0) runStart = column;
+            if (!rock && runStart >= 0) {
+                SubmitRect(list, LAYER_TERRAIN, (Rectangle){ runStart * TILE_SIZE, y, (column - runStart) * TILE_SIZE, TILE_SIZE }, rockColor);
+                runStart = -1;
+            }
+        }
+    }
+}
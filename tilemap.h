@@ -0,0 +1,65 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include "raylib.h"
+#include "drawlist.h"
+
+#define TILE_SIZE 40
+#define TILE_CHUNK_ROWS 16           // Rows per chunk; a chunk spans the full map width
+
+typedef enum TileKind {
+    TILE_WATER,
+    TILE_ROCK
+} TileKind;
+
+// A scrolling cavern level. Level space runs from row 0 at the far end down
+// to the last row at the start, and the screen shows the rows below a top
+// edge that counts down to 0 as the level scrolls.
+//
+// The layout is a pure function of the seed, so nothing per level is stored:
+// rows are generated a chunk at a time into a small ring of slots as the
+// screen reaches them, and a slot is reused once its chunk has scrolled off
+// the bottom. Memory depends on the screen size, never the level length.
+typedef struct TileMap {
+    unsigned int seed;
+    int rows;                    // Level length
+    int columns;
+    int visibleRows;
+    int slotCount;
+    int *slotChunk;              // Chunk each slot holds, -1 when empty
+    unsigned char *tiles;        // slotCount chunks of TILE_CHUNK_ROWS * columns
+
+    // Streaming counters, for the debug overlay
+    int resident;
+    int streamed;
+    int evicted;
+} TileMap;
+
+// Where a run is in its cavern; plain data, saved with the run
+typedef struct CavernState {
+    bool active;
+    unsigned int seed;
+    int rows;
+    float top;                   // Level-space y of the screen's top edge
+} CavernState;
+
+TileMap *LoadTileMap(int screenWidth, int screenHeight);
+void UnloadTileMap(TileMap *map);
+// Level-space y of the screen's top edge when a level of this length starts
+float GetTileMapStart(const TileMap *map, int rows);
+// Switches to the level of seed and rows if it is not the current one, then
+// makes sure the chunks from top down to the bottom of the screen, and one
+// chunk beyond top, are resident; chunks below the screen are released
+void StreamTileMap(TileMap *map, unsigned int seed, int rows, float top);
+// Columns outside the map are rock, rows before and after the level are water.
+// Chunks that are not resident are generated on the spot, so lookups never
+// depend on what has been streamed.
+TileKind GetTile(const TileMap *map, int column, int row);
+// Whether any tile rect (in level space) covers is rock
+bool IsTileMapSolid(const TileMap *map, Rectangle rect);
+// How far rect can travel by distance along one axis before its leading edge meets rock
+float MoveAcrossTiles(const TileMap *map, Rectangle rect, float distance, bool vertical);
+// Submits the rock on screen as one rectangle per horizontal run of tiles
+void DrawTileMap(const TileMap *map, float top, DrawList *list);
+
+#endif
@@ -0,0 +1,292 @@
+#include "ui.h"
+#include <stdlib.h>
+#include <string.h>
+
+static Rectangle UnionRects(Rectangle a, Rectangle b) {
+    float minX = (a.x < b.x) ? a.x : b.x;
+    float minY = (a.y < b.y) ? a.y : b.y;
+    float maxX = (a.x + a.width > b.x + b.width) ? a.x + a.width : b.x + b.width;
+    float maxY = (a.y + a.height > b.y + b.height) ? a.y + a.height : b.y + b.height;
+    return (Rectangle){ minX, minY, maxX - minX, maxY - minY };
+}
+
+UiLayer LoadUiLayer(int width, int height, UiDrawFn draw, void *context) {
+    UiLayer layer = { 0 };
+    layer.target = LoadRenderTexture(width, height);
+    layer.draw = draw;
+    layer.context = context;
+    layer.fullRedraw = true;
+    return layer;
+}
+
+void UnloadUiLayer(UiLayer layer) {
+    UnloadRenderTexture(layer.target);
+}
+
+void InvalidateUiLayer(UiLayer *layer) {
+    layer->fullRedraw = true;
+    layer->dirtyCount = 0;
+}
+
+void InvalidateUiRegion(UiLayer *layer, Rectangle region) {
+    if (layer->fullRedraw) return;
+
+    // Overlapping regions are merged so every pixel is cleared and redrawn once
+    for (int i = 0; i < layer->dirtyCount; i++) {
+        if (CheckCollisionRecs(layer->dirty[i], region)) {
+            region = UnionRects(layer->dirty[i], region);
+            layer->dirty[i] = layer->dirty[--layer->dirtyCount];
+            i = -1;
+        }
+    }
+
+    if (layer->dirtyCount == UI_MAX_DIRTY_REGIONS) {
+        InvalidateUiLayer(layer);
+        return;
+    }
+    layer->dirty[layer->dirtyCount++] = region;
+}
+
+bool IsUiLayerDirty(const UiLayer *layer) {
+    return layer->fullRedraw || layer->dirtyCount > 0;
+}
+
+void UpdateUiLayer(UiLayer *layer) {
+    if (!IsUiLayerDirty(layer)) return;
+
+    BeginTextureMode(layer->target);
+    if (layer->fullRedraw) {
+        Rectangle all = { 0, 0, layer->target.texture.width, layer->target.texture.height };
+        ClearBackground(BLANK);
+        layer->draw(layer->context, all);
+    } else {
+        for (int i = 0; i < layer->dirtyCount; i++) {
+            Rectangle region = layer->dirty[i];
+            // glClear honours the scissor box, so only this region is wiped
+            BeginScissorMode(region.x, region.y, region.width, region.height);
+            ClearBackground(BLANK);
+            layer->draw(layer->context, region);
+            EndScissorMode();
+        }
+    }
+    EndTextureMode();
+
+    layer->fullRedraw = false;
+    layer->dirtyCount = 0;
+}
+
+void DrawUiLayer(UiLayer layer) {
+    // Render textures are stored bottom-up, so flip the source rectangle
+    Rectangle source = { 0, 0, layer.target.texture.width, -layer.target.texture.height };
+    DrawTextureRec(layer.target.texture, source, (Vector2){ 0, 0 }, WHITE);
+}
+
+static void DrawUiWidgets(void *context, Rectangle region);
+
+UiContext *LoadUiContext(int width, int height, UiTheme theme, TextSystem *text) {
+    UiContext *ui = calloc(1, sizeof(UiContext));
+    ui->layer = LoadUiLayer(width, height, DrawUiWidgets, ui);
+    ui->theme = theme;
+    ui->text = text;
+    ui->screen = -1;
+    ui->hot = -1;
+    return ui;
+}
+
+void UnloadUiContext(UiContext *ui) {
+    UnloadUiLayer(ui->layer);
+    free(ui);
+}
+
+void UiBegin(UiContext *ui, int screen) {
+    ui->mouse = GetMousePosition();
+    ui->mousePressed = IsMouseButtonPressed(MOUSE_BUTTON_LEFT);
+    ui->mouseDown = IsMouseButtonDown(MOUSE_BUTTON_LEFT);
+
+    // A different screen invalidates everything, including last frame's hit rects
+    if (screen != ui->screen) {
+        ui->screen = screen;
+        ui->hitCount = 0;
+        ui->drawnCount = 0;
+        ui->dropped = 0;
+        ui->truncated = 0;
+        InvalidateUiLayer(&ui->layer);
+    }
+
+    // Single hit-test pass over the packed rects; later widgets sit on top
+    ui->hot = -1;
+    for (int i = 0; i < ui->hitCount; i++) {
+        if (CheckCollisionPointRec(ui->mouse, ui->hitRects[i])) {
+            ui->hot = ui->hitWidgets[i];
+        }
+    }
+
+    ui->widgetCount = 0;
+}
+
+static UiWidget *PushWidget(UiContext *ui, UiWidgetType type, Rectangle bounds) {
+    if (ui->widgetCount == UI_MAX_WIDGETS) {
+        // Reported once per visit, not every frame the screen is declared
+        if (ui->dropped++ == 0) {
+            TraceLog(LOG_WARNING, "UI: screen %d declares more than %d widgets, the rest are not shown", ui->screen, UI_MAX_WIDGETS);
+        }
+        return NULL;
+    }
+
+    // Zeroed first so padding bytes never make two equal widgets compare different
+    UiWidget *widget = &ui->widgets[ui->widgetCount];
+    memset(widget, 0, sizeof(UiWidget));
+    widget->type = type;
+    widget->bounds = bounds;
+    widget->hot = (ui->hot == ui->widgetCount);
+    ui->widgetCount++;
+    return widget;
+}
+
+static void SetWidgetText(UiContext *ui, UiWidget *widget, const char *text) {
+    strncpy(widget->text, text, UI_MAX_TEXT - 1);
+    // Reported once per visit, like widgets past the cap
+    if (strlen(text) >= UI_MAX_TEXT && ui->truncated++ == 0) {
+        TraceLog(LOG_WARNING, "UI: screen %d cuts \"%s\" to %d characters", ui->screen, text, UI_MAX_TEXT - 1);
+    }
+}
+
+void UiLabelEx(UiContext *ui, int face, const char *text, Vector2 position, Color color) {
+    UiWidget *widget = PushWidget(ui, UI_WIDGET_LABEL, (Rectangle){ position.x, position.y, 0, 0 });
+    if (widget == NULL) return;
+
+    SetWidgetText(ui, widget, text);
+    widget->face = face;
+    widget->color = color;
+
+    // Layouts are cached by content, so measuring an unchanged label is a table lookup
+    Vector2 size = MeasureCachedText(ui->text, face, widget->text);
+    widget->bounds.width = size.x;
+    widget->bounds.height = size.y;
+}
+
+void UiLabel(UiContext *ui, const char *text, int x, int y, int fontSize, Color color) {
+    // Same metrics as DrawText with the default font
+    if (fontSize < 10) fontSize = 10;
+    UiLabelEx(ui, GetTextFace(ui->text, false, fontSize, fontSize / 10), text, (Vector2){ x, y }, color);
+}
+
+bool UiButton(UiContext *ui, Rectangle bounds, const char *text, int fontSize) {
+    UiWidget *widget = PushWidget(ui, UI_WIDGET_BUTTON, bounds);
+    if (widget == NULL) return false;
+
+    SetWidgetText(ui, widget, text);
+    widget->face = GetTextFace(ui->text, false, fontSize, fontSize / 10);
+    widget->color = WHITE;
+    return widget->hot && ui->mousePressed;
+}
+
+bool UiIconButton(UiContext *ui, Rectangle bounds, const char *text) {
+    UiWidget *widget = PushWidget(ui, UI_WIDGET_ICON_BUTTON, bounds);
+    if (widget == NULL) return false;
+
+    SetWidgetText(ui, widget, text);
+    widget->face = GetTextFace(ui->text, false, 20, 2);
+    widget->color = WHITE;
+    return widget->hot && ui->mousePressed;
+}
+
+bool UiSlider(UiContext *ui, Rectangle bounds, float *value) {
+    UiWidget *widget = PushWidget(ui, UI_WIDGET_SLIDER, bounds);
+    if (widget == NULL) return false;
+
+    bool changed = false;
+    if (widget->hot && ui->mouseDown) {
+        float newValue = (ui->mouse.x - bounds.x) / bounds.width;
+        if (newValue < 0) newValue = 0;
+        if (newValue > 1) newValue = 1;
+        changed = (newValue != *value);
+        *value = newValue;
+    }
+    widget->value = *value;
+    return changed;
+}
+
+// Area a widget covers on the layer; button textures are drawn at their own size
+static Rectangle GetWidgetExtent(const UiContext *ui, const UiWidget *widget) {
+    Texture2D texture;
+    if (widget->type == UI_WIDGET_BUTTON) {
+        texture = ui->theme.button;
+    } else if (widget->type == UI_WIDGET_ICON_BUTTON) {
+        texture = ui->theme.iconButton;
+    } else {
+        return widget->bounds;
+    }
+    return UnionRects(widget->bounds, (Rectangle){ widget->bounds.x, widget->bounds.y, texture.width, texture.height });
+}
+
+static void DrawWidgetText(const UiContext *ui, const UiWidget *widget) {
+    Rectangle b = widget->bounds;
+    Vector2 position = { b.x, b.y };
+
+    if (widget->type == UI_WIDGET_BUTTON) {
+        Vector2 size = MeasureCachedText(ui->text, widget->face, widget->text);
+        position = (Vector2){ (int)(b.x + (b.width - size.x) / 2), b.y + 10 };
+    } else if (widget->type == UI_WIDGET_ICON_BUTTON) {
+        position = (Vector2){ b.x + b.width / 2 - 10, b.y + b.height / 2 - 10 };
+    }
+    DrawCachedText(ui->text, widget->face, widget->text, position, widget->color);
+}
+
+// Widgets are drawn in passes grouped by texture so the batch is not flushed between them
+static void DrawUiWidgets(void *context, Rectangle region) {
+    const UiContext *ui = context;
+    const UiTheme *theme = &ui->theme;
+    const Texture2D *passes[] = { &theme->button, &theme->buttonHot, &theme->iconButton, &theme->iconButtonHot };
+
+    for (int pass = 0; pass < 4; pass++) {
+        UiWidgetType type = (pass < 2) ? UI_WIDGET_BUTTON : UI_WIDGET_ICON_BUTTON;
+        bool hot = (pass % 2) == 1;
+        for (int i = 0; i < ui->widgetCount; i++) {
+            const UiWidget *widget = &ui->widgets[i];
+            if (widget->type != type || widget->hot != hot) continue;
+            if (!CheckCollisionRecs(GetWidgetExtent(ui, widget), region)) continue;
+            DrawTexture(*passes[pass], widget->bounds.x, widget->bounds.y, WHITE);
+        }
+    }
+
+    for (int i = 0; i < ui->widgetCount; i++) {
+        const UiWidget *widget = &ui->widgets[i];
+        if (widget->type != UI_WIDGET_SLIDER || !CheckCollisionRecs(widget->bounds, region)) continue;
+        Rectangle filled = widget->bounds;
+        filled.width *= widget->value;
+        DrawRectangleRec(widget->bounds, DARKGRAY);
+        DrawRectangleRec(filled, GREEN);
+    }
+
+    for (int i = 0; i < ui->widgetCount; i++) {
+        const UiWidget *widget = &ui->widgets[i];
+        if (widget->type == UI_WIDGET_SLIDER) continue;
+        if (!CheckCollisionRecs(GetWidgetExtent(ui, widget), region)) continue;
+        DrawWidgetText(ui, widget);
+    }
+}
+
+void UiEnd(UiContext *ui) {
+    // Diff against what the layer shows and invalidate both old and new bounds of changed widgets
+    int count = (ui->widgetCount > ui->drawnCount) ? ui->widgetCount : ui->drawnCount;
+    for (int i = 0; i < count; i++) {
+        bool existsNow = i < ui->widgetCount;
+        bool existedBefore = i < ui->drawnCount;
+        if (existsNow && existedBefore && memcmp(&ui->widgets[i], &ui->drawn[i], sizeof(UiWidget)) == 0) continue;
+        if (existedBefore) InvalidateUiRegion(&ui->layer, GetWidgetExtent(ui, &ui->drawn[i]));
+        if (existsNow) InvalidateUiRegion(&ui->layer, GetWidgetExtent(ui, &ui->widgets[i]));
+    }
+
+    memcpy(ui->drawn, ui->widgets, ui->widgetCount * sizeof(UiWidget));
+    ui->drawnCount = ui->widgetCount;
+
+    // Pack interactive bounds for next frame's hit-test
+    ui->hitCount = 0;
+    for (int i = 0; i < ui->widgetCount; i++) {
+        if (ui->widgets[i].type == UI_WIDGET_LABEL) continue;
+        ui->hitRects[ui->hitCount] = ui->widgets[i].bounds;
+        ui->hitWidgets[ui->hitCount] = i;
+        ui->hitCount++;
+    }
+}
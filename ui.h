@@ -0,0 +1,92 @@
+#ifndef UI_H
+#define UI_H
+
+#include "raylib.h"
+#include "text.h"
+
+#define UI_MAX_DIRTY_REGIONS 16
+#define UI_MAX_WIDGETS 64
+#define UI_MAX_TEXT 48
+
+// Callback that draws the layer contents; it is clipped to the region being refreshed
+typedef void (*UiDrawFn)(void *context, Rectangle region);
+
+// Off-screen layer for UI that rarely changes. Only invalidated regions are
+// re-rendered into the render texture, and the layer is composited with one blit.
+typedef struct UiLayer {
+    RenderTexture2D target;
+    UiDrawFn draw;
+    void *context;
+    Rectangle dirty[UI_MAX_DIRTY_REGIONS];
+    int dirtyCount;
+    bool fullRedraw;
+} UiLayer;
+
+typedef enum UiWidgetType {
+    UI_WIDGET_LABEL,
+    UI_WIDGET_BUTTON,
+    UI_WIDGET_ICON_BUTTON,
+    UI_WIDGET_SLIDER
+} UiWidgetType;
+
+// One declared widget. Widgets are compared byte-for-byte against the previous
+// frame, so everything that affects their look lives in here.
+typedef struct UiWidget {
+    UiWidgetType type;
+    Rectangle bounds;
+    char text[UI_MAX_TEXT];
+    int face;
+    Color color;
+    float value;
+    bool hot;
+} UiWidget;
+
+typedef struct UiTheme {
+    Texture2D button;
+    Texture2D buttonHot;
+    Texture2D iconButton;
+    Texture2D iconButtonHot;
+} UiTheme;
+
+// Immediate-mode UI: screens declare their widgets every frame between UiBegin
+// and UiEnd, while hit-testing and drawing run once per frame over packed arrays.
+// UiEnd only records what changed; the layer is refreshed when it is composited.
+typedef struct UiContext {
+    UiLayer layer;
+    UiTheme theme;
+    TextSystem *text;
+    UiWidget widgets[UI_MAX_WIDGETS];        // Declared this frame
+    UiWidget drawn[UI_MAX_WIDGETS];          // What the layer currently shows
+    int widgetCount;
+    int drawnCount;
+    Rectangle hitRects[UI_MAX_WIDGETS];      // Interactive bounds from the last frame
+    int hitWidgets[UI_MAX_WIDGETS];
+    int hitCount;
+    int screen;
+    int dropped;                             // Widgets this screen declared past the cap
+    int truncated;                           // Widget texts this screen cut at UI_MAX_TEXT
+    int hot;                                 // Widget under the mouse, -1 if none
+    Vector2 mouse;
+    bool mousePressed;
+    bool mouseDown;
+} UiContext;
+
+UiLayer LoadUiLayer(int width, int height, UiDrawFn draw, void *context);
+void UnloadUiLayer(UiLayer layer);
+void InvalidateUiLayer(UiLayer *layer);
+void InvalidateUiRegion(UiLayer *layer, Rectangle region);
+bool IsUiLayerDirty(const UiLayer *layer);
+void UpdateUiLayer(UiLayer *layer);
+void DrawUiLayer(UiLayer layer);
+
+UiContext *LoadUiContext(int width, int height, UiTheme theme, TextSystem *text);
+void UnloadUiContext(UiContext *ui);
+void UiBegin(UiContext *ui, int screen);
+void UiEnd(UiContext *ui);
+void UiLabel(UiContext *ui, const char *text, int x, int y, int fontSize, Color color);
+void UiLabelEx(UiContext *ui, int face, const char *text, Vector2 position, Color color);
+bool UiButton(UiContext *ui, Rectangle bounds, const char *text, int fontSize);
+bool UiIconButton(UiContext *ui, Rectangle bounds, const char *text);
+bool UiSlider(UiContext *ui, Rectangle bounds, float *value);
+
+#endif
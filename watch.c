@@ -0,0 +1,135 @@
+// stat and the inotify calls are POSIX and Linux, not C99
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "watch.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+static long long GetModifiedTime(const FileWatch *watch) {
+    char path[sizeof(watch->directory) + sizeof(watch->name) + 1];
+    snprintf(path, sizeof(path), "%s/%s", watch->directory, watch->name);
+    struct stat info;
+    if (stat(path, &info) != 0) return -1;
+    return (long long)info.st_mtime;
+}
+
+static bool SplitPath(const char *fileName, FileWatch *watch) {
+    *watch = (FileWatch){ .descriptor = -1 };
+    const char *slash = strrchr(fileName, '/');
+    const char *backslash = strrchr(fileName, '\\');
+    if (backslash > slash) slash = backslash;
+
+    const char *name = (slash != NULL) ? slash + 1 : fileName;
+    size_t directoryLength = (slash != NULL) ? (size_t)(slash - fileName) : 1;
+    if (strlen(name) >= sizeof(watch->name) || directoryLength >= sizeof(watch->directory)) return false;
+
+    strcpy(watch->name, name);
+    if (slash != NULL) {
+        memcpy(watch->directory, fileName, directoryLength);
+        watch->directory[directoryLength] = '\0';
+    } else {
+        strcpy(watch->directory, ".");
+    }
+    watch->modified = GetModifiedTime(watch);
+    return true;
+}
+
+#ifndef __linux__
+// A notification only says something in the directory changed; the file's own
+// time says whether it was this file
+static bool CheckModified(FileWatch *watch) {
+    long long modified = GetModifiedTime(watch);
+    if (modified < 0 || modified == watch->modified) return false;
+    watch->modified = modified;
+    return true;
+}
+#endif
+
+#ifdef _WIN32
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+bool WatchFile(const char *fileName, FileWatch *watch) {
+    if (!SplitPath(fileName, watch)) return false;
+    HANDLE handle = FindFirstChangeNotificationA(watch->directory, FALSE,
+        FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    watch->handle = handle;
+    return true;
+}
+
+void UnwatchFile(FileWatch *watch) {
+    if (watch->handle != NULL) FindCloseChangeNotification(watch->handle);
+    watch->handle = NULL;
+}
+
+bool PollFileWatch(FileWatch *watch) {
+    if (watch->handle == NULL || WaitForSingleObject(watch->handle, 0) != WAIT_OBJECT_0) return false;
+    FindNextChangeNotification(watch->handle);
+    return CheckModified(watch);
+}
+
+#elif defined(__linux__)
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+bool WatchFile(const char *fileName, FileWatch *watch) {
+    if (!SplitPath(fileName, watch)) return false;
+    int descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (descriptor < 0) return false;
+
+    // Close-after-write rather than every write, so a half-saved file is never read
+    if (inotify_add_watch(descriptor, watch->directory, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        close(descriptor);
+        return false;
+    }
+    watch->descriptor = descriptor;
+    return true;
+}
+
+void UnwatchFile(FileWatch *watch) {
+    if (watch->descriptor >= 0) close(watch->descriptor);
+    watch->descriptor = -1;
+}
+
+bool PollFileWatch(FileWatch *watch) {
+    if (watch->descriptor < 0) return false;
+
+    // Drain every queued event; several saves between polls count as one
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    bool changed = false;
+    for (;;) {
+        ssize_t length = read(watch->descriptor, buffer, sizeof(buffer));
+        if (length <= 0) break;
+        for (char *p = buffer; p < buffer + length; ) {
+            const struct inotify_event *event = (const struct inotify_event *)p;
+            if (event->len > 0 && strcmp(event->name, watch->name) == 0) changed = true;
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    if (changed) watch->modified = GetModifiedTime(watch);
+    return changed;
+}
+
+#else
+
+// No notification API: compare the modification time on every poll
+bool WatchFile(const char *fileName, FileWatch *watch) {
+    return SplitPath(fileName, watch);
+}
+
+void UnwatchFile(FileWatch *watch) {
+    (void)watch;
+}
+
+bool PollFileWatch(FileWatch *watch) {
+    return CheckModified(watch);
+}
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+#include <stdbool.h>
+
+// Tells when a file has been saved, without reading it every frame. Watches
+// the containing directory, so editors that save by renaming a temporary file
+// over the original are seen too. Kept apart from raylib.h because windows.h
+// clashes with raylib's names.
+typedef struct FileWatch {
+    char directory[256];
+    char name[128];
+    long long modified;          // Modification time last reported
+    void *handle;                // Windows change notification
+    int descriptor;              // inotify instance on Linux, -1 otherwise
+} FileWatch;
+
+bool WatchFile(const char *fileName, FileWatch *watch);
+void UnwatchFile(FileWatch *watch);
+// True once for each save since the last poll; never blocks
+bool PollFileWatch(FileWatch *watch);
+
+#endif
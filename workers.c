@@ -0,0 +1,213 @@
+// pthreads and sysconf are POSIX, not C99
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "workers.h"
+#include <stdlib.h>
+#include <stdbool.h>
+
+#ifdef _WIN32
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+typedef CRITICAL_SECTION Mutex;
+typedef CONDITION_VARIABLE Condition;
+typedef HANDLE Thread;
+
+#define InitMutex(m) InitializeCriticalSection(m)
+#define DestroyMutex(m) DeleteCriticalSection(m)
+#define LockMutex(m) EnterCriticalSection(m)
+#define UnlockMutex(m) LeaveCriticalSection(m)
+#define InitCondition(c) InitializeConditionVariable(c)
+#define DestroyCondition(c) ((void)(c))
+#define WaitCondition(c, m) SleepConditionVariableCS(c, m, INFINITE)
+#define WakeAll(c) WakeAllConditionVariable(c)
+
+#else
+
+#include <pthread.h>
+#include <unistd.h>
+
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t Condition;
+typedef pthread_t Thread;
+
+#define InitMutex(m) pthread_mutex_init(m, NULL)
+#define DestroyMutex(m) pthread_mutex_destroy(m)
+#define LockMutex(m) pthread_mutex_lock(m)
+#define UnlockMutex(m) pthread_mutex_unlock(m)
+#define InitCondition(c) pthread_cond_init(c, NULL)
+#define DestroyCondition(c) pthread_cond_destroy(c)
+#define WaitCondition(c, m) pthread_cond_wait(c, m)
+#define WakeAll(c) pthread_cond_broadcast(c)
+
+#endif
+
+typedef struct Worker {
+    WorkerPool *pool;
+    int index;
+    Thread thread;
+} Worker;
+
+struct WorkerPool {
+    int threadCount;
+    Worker *workers;             // threadCount - 1; the caller is participant 0
+    Mutex mutex;
+    Condition start;
+    Condition done;
+
+    // The current job, published under the mutex
+    WorkerJob job;
+    void *context;
+    int count;
+    unsigned int generation;     // Bumped for every job, so a worker never runs one twice
+    int running;                 // Workers still inside the current job
+    bool quit;
+};
+
+static void RunShare(WorkerPool *pool, int participant) {
+    for (int i = participant; i < pool->count; i += pool->threadCount) {
+        pool->job(pool->context, i);
+    }
+}
+
+static void WorkerLoop(Worker *worker) {
+    WorkerPool *pool = worker->pool;
+    unsigned int seen = 0;
+
+    LockMutex(&pool->mutex);
+    for (;;) {
+        while (!pool->quit && pool->generation == seen) {
+            WaitCondition(&pool->start, &pool->mutex);
+        }
+        if (pool->quit) break;
+        seen = pool->generation;
+        UnlockMutex(&pool->mutex);
+
+        RunShare(pool, worker->index);
+
+        LockMutex(&pool->mutex);
+        if (--pool->running == 0) WakeAll(&pool->done);
+    }
+    UnlockMutex(&pool->mutex);
+}
+
+#ifdef _WIN32
+
+static DWORD WINAPI WorkerMain(LPVOID parameter) {
+    WorkerLoop(parameter);
+    return 0;
+}
+
+static bool StartThread(Worker *worker) {
+    worker->thread = CreateThread(NULL, 0, WorkerMain, worker, 0, NULL);
+    return worker->thread != NULL;
+}
+
+static void JoinThread(Worker *worker) {
+    WaitForSingleObject(worker->thread, INFINITE);
+    CloseHandle(worker->thread);
+}
+
+int GetProcessorCount(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+}
+
+#else
+
+static void *WorkerMain(void *parameter) {
+    WorkerLoop(parameter);
+    return NULL;
+}
+
+static bool StartThread(Worker *worker) {
+    return pthread_create(&worker->thread, NULL, WorkerMain, worker) == 0;
+}
+
+static void JoinThread(Worker *worker) {
+    pthread_join(worker->thread, NULL);
+}
+
+int GetProcessorCount(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+
+#endif
+
+WorkerPool *LoadWorkerPool(int threadCount) {
+    WorkerPool *pool = calloc(1, sizeof(WorkerPool));
+    if (pool == NULL) return NULL;
+    if (threadCount < 1) threadCount = 1;
+
+    pool->workers = calloc(threadCount, sizeof(Worker));
+    if (pool->workers == NULL) {
+        free(pool);
+        return NULL;
+    }
+    InitMutex(&pool->mutex);
+    InitCondition(&pool->start);
+    InitCondition(&pool->done);
+
+    // A thread that fails to start just leaves its share to fewer participants
+    pool->threadCount = 1;
+    for (int t = 1; t < threadCount; t++) {
+        Worker *worker = &pool->workers[pool->threadCount - 1];
+        worker->pool = pool;
+        worker->index = pool->threadCount;
+        if (!StartThread(worker)) break;
+        pool->threadCount++;
+    }
+    return pool;
+}
+
+void UnloadWorkerPool(WorkerPool *pool) {
+    if (pool == NULL) return;
+
+    LockMutex(&pool->mutex);
+    pool->quit = true;
+    WakeAll(&pool->start);
+    UnlockMutex(&pool->mutex);
+
+    for (int t = 0; t < pool->threadCount - 1; t++) {
+        JoinThread(&pool->workers[t]);
+    }
+    DestroyCondition(&pool->start);
+    DestroyCondition(&pool->done);
+    DestroyMutex(&pool->mutex);
+    free(pool->workers);
+    free(pool);
+}
+
+void RunWorkers(WorkerPool *pool, WorkerJob job, void *context, int count) {
+    // Too little work to be worth waking anyone
+    if (pool->threadCount == 1 || count <= 1) {
+        for (int i = 0; i < count; i++) job(context, i);
+        return;
+    }
+
+    LockMutex(&pool->mutex);
+    pool->job = job;
+    pool->context = context;
+    pool->count = count;
+    pool->running = pool->threadCount - 1;
+    pool->generation++;
+    WakeAll(&pool->start);
+    UnlockMutex(&pool->mutex);
+
+    RunShare(pool, 0);
+
+    LockMutex(&pool->mutex);
+    while (pool->running > 0) {
+        WaitCondition(&pool->done, &pool->mutex);
+    }
+    UnlockMutex(&pool->mutex);
+}
+
+int GetWorkerCount(const WorkerPool *pool) {
+    return pool->threadCount;
+}
@@ -0,0 +1,21 @@
+#ifndef WORKERS_H
+#define WORKERS_H
+
+// Fixed set of threads that run one job over an index range and then sleep
+// until the next. Kept apart from raylib.h because windows.h clashes with
+// raylib's names.
+typedef void (*WorkerJob)(void *context, int index);
+
+typedef struct WorkerPool WorkerPool;
+
+// threadCount includes the calling thread, which works alongside the pool
+WorkerPool *LoadWorkerPool(int threadCount);
+void UnloadWorkerPool(WorkerPool *pool);
+// Calls job(context, i) for every i in [0, count) and returns once all have
+// finished. Thread t takes indices t, t + threadCount, ..., so jobs of similar
+// cost need no shared counter.
+void RunWorkers(WorkerPool *pool, WorkerJob job, void *context, int count);
+int GetWorkerCount(const WorkerPool *pool);
+int GetProcessorCount(void);
+
+#endif